@@ -0,0 +1,547 @@
+// -----------------------------------------
+//
+// Close-by-One batch runner
+//
+// Enumerates the concepts of many small contexts in one process. The .cxt files of the given directories and
+// manifests are shared out to a fixed pool of worker threads, one context per task, each enumerated with libcbo.
+// Concepts are optionally written to one text file per context, and the concept count, load and enumeration time
+// of every file are reported with the files per second of the whole batch.
+//
+// -----------------------------------------
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include "libcbo.h"
+
+#define OUTPUT_BUFFER_SIZE (1 << 16) // bytes of concept text buffered before writing
+#define RECORD_DIGITS 11 // bytes of one index in a text record, separator and up to ten digits
+
+// define job_t for hold one context of the batch and its result
+typedef struct {
+    char *path;
+    char *output; // concept text file name inside output_dir, unique in the batch
+    long concepts; // -1 when the context failed
+    double load_seconds; // read and parse
+    double enumeration_seconds;
+    char error[CBO_ERROR_SIZE]; // reason of a failure
+} job_t;
+
+// define output_t for hold concept text of one context while it is enumerated
+typedef struct {
+    FILE *file;
+    char *buffer; // OUTPUT_BUFFER_SIZE bytes
+    size_t used;
+    bool failed; // a write failed, the rest of the output is dropped
+} output_t;
+
+int thread_count = 0; // holds worker threads, 0 for one per core
+char *output_dir = NULL; // holds per context concept output directory, nothing written when NULL
+long check_slice = 0; // holds concept budget of each iterator slice of the self-check, no check when 0
+job_t *jobs = NULL; // holds every context of the batch in input order
+long job_count = 0;
+atomic_long next_job; // holds index of the next job a worker claims
+
+// local functions
+void usage(char *program);
+
+void addJob(char *path);
+
+void collectDirectory(char *path);
+
+void collectManifest(char *path);
+
+void nameOutputs(void);
+
+int compareOutputs(const void *a, const void *b);
+
+void *workerLoop(void *arg);
+
+void runJob(job_t *job, char **data, size_t *capacity, char *buffer);
+
+bool checkIterator(const cbo_context_t *context, long concepts, char *error);
+
+bool readFile(char *path, char **data, size_t *capacity, size_t *size, char *error);
+
+FILE *openOutput(char *name, char *error);
+
+bool writeConcept(const cbo_concept_t *concept, void *user_data);
+
+void flushOutput(output_t *output);
+
+char *writeIndices(char *cursor, const int *indices, int count, bool leading);
+
+double elapsedSeconds(struct timespec *from, struct timespec *to);
+
+int main(int argc, char *argv[]) {
+    int opt, i;
+    while ((opt = getopt(argc, argv, "t:o:m:k:")) != -1) {
+        switch (opt) {
+            case 't':
+                thread_count = atoi(optarg);
+                if (thread_count < 1) {
+                    usage(argv[0]);
+                }
+                break;
+            case 'o':
+                output_dir = optarg;
+                break;
+            case 'm':
+                collectManifest(optarg);
+                break;
+            case 'k':
+                check_slice = atol(optarg);
+                if (check_slice < 1) {
+                    usage(argv[0]);
+                }
+                break;
+            default:
+                usage(argv[0]);
+        }
+    }
+    // contexts, every .cxt of a directory in name order
+    for (i = optind; i < argc; i++) {
+        struct stat info;
+        if (stat(argv[i], &info) == 0 && S_ISDIR(info.st_mode)) {
+            collectDirectory(argv[i]);
+        } else {
+            addJob(argv[i]);
+        }
+    }
+    if (job_count == 0) {
+        usage(argv[0]);
+    }
+    if (thread_count == 0) {
+        long cores = sysconf(_SC_NPROCESSORS_ONLN);
+        thread_count = (cores > 0) ? (int) cores : 1;
+    }
+    if (thread_count > job_count) {
+        thread_count = (int) job_count; // a worker per context at most
+    }
+    if (output_dir != NULL && mkdir(output_dir, 0777) != 0 && errno != EEXIST) {
+        int err_num = errno;
+        fprintf(stderr, "Error creating directory: %s: %s\n", output_dir, strerror(err_num));
+        exit(EXIT_FAILURE);
+    }
+    if (output_dir != NULL) {
+        nameOutputs();
+    }
+
+    // 1. run the batch on the worker pool
+    struct timespec from, to;
+    pthread_t *threads = (pthread_t *) malloc(thread_count * sizeof(pthread_t));
+    atomic_init(&next_job, 0);
+    clock_gettime(CLOCK_MONOTONIC, &from);
+    for (i = 0; i < thread_count; i++) {
+        if (pthread_create(&threads[i], NULL, workerLoop, NULL) != 0) {
+            fprintf(stderr, "Error creating worker thread\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    for (i = 0; i < thread_count; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &to);
+    free(threads);
+
+    // 2. per file results in input order, then the batch
+    long total = 0;
+    long failures = 0;
+    long j;
+    for (j = 0; j < job_count; j++) {
+        job_t *job = &jobs[j];
+        if (job->concepts < 0) {
+            printf("%-40s failed : %s\n", job->path, job->error);
+            failures++;
+        } else {
+            printf("%-40s concepts %10ld  load %10.6f s  enum %10.6f s\n", job->path, job->concepts,
+                   job->load_seconds, job->enumeration_seconds);
+            total += job->concepts;
+        }
+    }
+    double seconds = elapsedSeconds(&from, &to);
+    printf("\nTotal Files : %ld (%ld failed)\n\n", job_count, failures);
+    printf("Total Concepts : %ld\n\n", total);
+    printf("execution time : %f seconds, %d threads\n\n", seconds, thread_count);
+    printf("throughput : %.1f files/sec\n\n", seconds > 0 ? job_count / seconds : 0.0);
+
+    for (j = 0; j < job_count; j++) {
+        free(jobs[j].path);
+        free(jobs[j].output);
+    }
+    free(jobs);
+    return failures > 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+// print command line usage and exit
+void usage(char *program) {
+    fprintf(stderr, "usage: %s [-t threads] [-o output_dir] [-m manifest] [-k concepts]\n"
+                    "          [context.cxt | directory ...]\n", program);
+    fprintf(stderr, "  -t  worker threads (default: one per core)\n");
+    fprintf(stderr, "  -o  directory for one text concept file per context, <name>.txt (default: counts only),\n"
+                    "      <name>.<n>.txt for contexts sharing a name, n their position in the batch\n");
+    fprintf(stderr, "  -m  file listing one context path per line, may be repeated\n");
+    fprintf(stderr, "  -k  check the iterator, concepts pulled again with this budget per slice match the count\n");
+    exit(EXIT_FAILURE);
+}
+
+// append context to the batch
+void addJob(char *path) {
+    if (job_count % 1024 == 0) {
+        jobs = (job_t *) realloc(jobs, (job_count + 1024) * sizeof(job_t));
+        if (jobs == NULL) {
+            fprintf(stderr, "Error allocating %ld jobs\n", job_count + 1024);
+            exit(EXIT_FAILURE);
+        }
+    }
+    job_t *job = &jobs[job_count++];
+    memset(job, 0, sizeof(job_t));
+    job->path = strdup(path);
+    job->concepts = -1;
+}
+
+// append every .cxt of a directory in name order
+void collectDirectory(char *path) {
+    struct dirent **entries;
+    int entry_count = scandir(path, &entries, NULL, alphasort);
+    int e;
+    if (entry_count < 0) {
+        int err_num = errno;
+        fprintf(stderr, "Error opening directory: %s: %s\n", path, strerror(err_num));
+        exit(EXIT_FAILURE);
+    }
+    for (e = 0; e < entry_count; e++) {
+        size_t len = strlen(entries[e]->d_name);
+        if (len > 4 && strcmp(entries[e]->d_name + len - 4, ".cxt") == 0) {
+            char file_path[strlen(path) + len + 2];
+            snprintf(file_path, sizeof(file_path), "%s/%s", path, entries[e]->d_name);
+            addJob(file_path);
+        }
+        free(entries[e]);
+    }
+    free(entries);
+}
+
+// append every path listed in a manifest, blank lines and lines starting with '#' are skipped
+void collectManifest(char *path) {
+    FILE *file = fopen(path, "r");
+    if (file == NULL) {
+        int err_num = errno;
+        fprintf(stderr, "Error opening file: %s: %s\n", path, strerror(err_num));
+        exit(EXIT_FAILURE);
+    }
+    char *line = NULL;
+    size_t capacity = 0;
+    ssize_t length;
+    while ((length = getline(&line, &capacity, file)) != -1) {
+        while (length > 0 && (line[length - 1] == '\n' || line[length - 1] == '\r')) {
+            line[--length] = '\0';
+        }
+        if (length > 0 && line[0] != '#') {
+            addJob(line);
+        }
+    }
+    free(line);
+    fclose(file);
+}
+
+/**
+ * name the concept file of every job after its context, "<name>.txt" for name.cxt
+ *
+ * Contexts of the same name from different directories (or one listed twice) would write the same file from two
+ * workers at once, each of them is named "<name>.<n>.txt" instead, n its position in the batch. A name still shared
+ * after that is refused.
+ */
+void nameOutputs(void) {
+    job_t **order = (job_t **) malloc(job_count * sizeof(job_t *));
+    long j, k;
+    if (order == NULL) {
+        fprintf(stderr, "Error allocating %ld output names\n", job_count);
+        exit(EXIT_FAILURE);
+    }
+    // 1. context name without directory and .cxt
+    for (j = 0; j < job_count; j++) {
+        char *name = strrchr(jobs[j].path, '/');
+        name = (name != NULL) ? name + 1 : jobs[j].path;
+        size_t len = strlen(name);
+        if (len > 4 && strcmp(name + len - 4, ".cxt") == 0) {
+            len -= 4;
+        }
+        jobs[j].output = strndup(name, len);
+        order[j] = &jobs[j];
+    }
+    // 2. number every job of a shared name
+    qsort(order, job_count, sizeof(job_t *), compareOutputs);
+    for (j = 0; j < job_count; j = k) {
+        k = j + 1;
+        while (k < job_count && compareOutputs(&order[j], &order[k]) == 0) {
+            k++;
+        }
+        long d;
+        for (d = j; k - j > 1 && d < k; d++) {
+            char *name = order[d]->output;
+            size_t size = strlen(name) + 22;
+            order[d]->output = (char *) malloc(size);
+            snprintf(order[d]->output, size, "%s.%ld", name, (long) (order[d] - jobs) + 1);
+            free(name);
+        }
+    }
+    // 3. numbered names may meet a context named like them
+    qsort(order, job_count, sizeof(job_t *), compareOutputs);
+    for (j = 1; j < job_count; j++) {
+        if (compareOutputs(&order[j - 1], &order[j]) == 0) {
+            fprintf(stderr, "Error naming output: %s and %s both write %s/%s.txt\n", order[j - 1]->path,
+                    order[j]->path, output_dir, order[j]->output);
+            exit(EXIT_FAILURE);
+        }
+    }
+    free(order);
+}
+
+// ascending order of job output names
+int compareOutputs(const void *a, const void *b) {
+    return strcmp((*(job_t *const *) a)->output, (*(job_t *const *) b)->output);
+}
+
+// claim and run jobs until none is left, read and output buffers are reused across jobs
+void *workerLoop(void *arg) {
+    (void) arg;
+    char *data = NULL;
+    size_t capacity = 0;
+    char *buffer = (output_dir != NULL) ? (char *) malloc(OUTPUT_BUFFER_SIZE) : NULL;
+    long j;
+    while ((j = atomic_fetch_add(&next_job, 1)) < job_count) {
+        runJob(&jobs[j], &data, &capacity, buffer);
+    }
+    free(data);
+    free(buffer);
+    return NULL;
+}
+
+/**
+ * load one context and enumerate its concepts, the result is kept in the job
+ *
+ * input :  1. job
+ *          2. read buffer of the worker, grown to the file
+ *          3. read buffer size
+ *          4. output buffer of the worker, NULL when concepts are only counted
+ */
+void runJob(job_t *job, char **data, size_t *capacity, char *buffer) {
+    struct timespec from, loaded, to;
+    size_t size;
+    clock_gettime(CLOCK_MONOTONIC, &from);
+    // 1. read and parse
+    if (!readFile(job->path, data, capacity, &size, job->error)) {
+        return;
+    }
+    cbo_context_t *context = cboLoadContext(*data, size, job->error, sizeof(job->error));
+    if (context == NULL) {
+        return;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &loaded);
+    // 2. enumerate, into the text file of the context when written
+    output_t output;
+    memset(&output, 0, sizeof(output));
+    output.buffer = buffer;
+    if (buffer != NULL && (output.file = openOutput(job->output, job->error)) == NULL) {
+        cboFreeContext(context);
+        return;
+    }
+    long concepts = cboEnumerate(context, (buffer != NULL) ? writeConcept : NULL, &output);
+    if (output.file != NULL) {
+        flushOutput(&output);
+        if (fclose(output.file) != 0) {
+            output.failed = true;
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &to);
+    // 3. pull the concepts again in budget slices when checked, outside the timed enumeration
+    if (concepts >= 0 && check_slice > 0 && !checkIterator(context, concepts, job->error)) {
+        cboFreeContext(context);
+        if (output.failed) {
+            snprintf(job->error, sizeof(job->error), "concept output not written");
+        }
+        return;
+    }
+    cboFreeContext(context);
+    if (concepts < 0) {
+        snprintf(job->error, sizeof(job->error), "out of memory");
+        return;
+    }
+    if (output.failed) {
+        snprintf(job->error, sizeof(job->error), "concept output not written");
+        return;
+    }
+    job->concepts = concepts;
+    job->load_seconds = elapsedSeconds(&from, &loaded);
+    job->enumeration_seconds = elapsedSeconds(&loaded, &to);
+}
+
+/**
+ * pull the concepts of a context with a budget of check_slice concepts, set again after every CBO_BUDGET, false
+ * with the reason when a slice overruns its budget or the total differs from the enumeration
+ *
+ * input :  1. context
+ *          2. concepts counted by cboEnumerate
+ *          3. error buffer of the job
+ */
+bool checkIterator(const cbo_context_t *context, long concepts, char *error) {
+    cbo_concept_t concept;
+    long pulled = 0;
+    long slices = 0;
+    cbo_iterator_t *iterator = cboOpenIterator(context);
+    if (iterator == NULL) {
+        snprintf(error, CBO_ERROR_SIZE, "out of memory");
+        return false;
+    }
+    do {
+        long slice = 0;
+        cboSetBudget(iterator, check_slice, 0);
+        while (cboNext(iterator, &concept)) {
+            slice++;
+        }
+        // a concept budget stops right after its last concept
+        if (slice > check_slice || (cboStatus(iterator) == CBO_BUDGET && slice != check_slice)) {
+            snprintf(error, CBO_ERROR_SIZE, "iterator slice %ld returned %ld concepts, budget %ld", slices, slice,
+                     check_slice);
+            cboCloseIterator(iterator);
+            return false;
+        }
+        pulled += slice;
+        slices++;
+    } while (cboStatus(iterator) == CBO_BUDGET);
+    cbo_status_t status = cboStatus(iterator);
+    long returned = cboReturned(iterator);
+    cboCloseIterator(iterator);
+    if (status == CBO_NO_MEMORY) {
+        snprintf(error, CBO_ERROR_SIZE, "out of memory");
+        return false;
+    }
+    if (pulled != concepts || returned != concepts) {
+        snprintf(error, CBO_ERROR_SIZE, "iterator returned %ld concepts in %ld slices, enumeration %ld", pulled,
+                 slices, concepts);
+        return false;
+    }
+    return true;
+}
+
+// read whole file into the buffer, grown when too small, false with the reason on failure
+bool readFile(char *path, char **data, size_t *capacity, size_t *size, char *error) {
+    struct stat info;
+    int fd = open(path, O_RDONLY);
+    if (fd == -1 || fstat(fd, &info) == -1) {
+        snprintf(error, CBO_ERROR_SIZE, "%s", strerror(errno));
+        if (fd != -1) {
+            close(fd);
+        }
+        return false;
+    }
+    if ((size_t) info.st_size > *capacity) {
+        free(*data);
+        *capacity = (size_t) info.st_size;
+        *data = (char *) malloc(*capacity);
+        if (*data == NULL) {
+            *capacity = 0;
+            snprintf(error, CBO_ERROR_SIZE, "out of memory");
+            close(fd);
+            return false;
+        }
+    }
+    size_t done = 0;
+    while (done < (size_t) info.st_size) {
+        ssize_t got = read(fd, *data + done, info.st_size - done);
+        if (got <= 0) {
+            snprintf(error, CBO_ERROR_SIZE, "truncated read");
+            close(fd);
+            return false;
+        }
+        done += got;
+    }
+    close(fd);
+    *size = done;
+    return true;
+}
+
+// open "<output_dir>/<output name>.txt", NULL with the reason on failure
+FILE *openOutput(char *name, char *error) {
+    char file_path[strlen(output_dir) + strlen(name) + 6];
+    snprintf(file_path, sizeof(file_path), "%s/%s.txt", output_dir, name);
+    FILE *file = fopen(file_path, "w");
+    if (file == NULL) {
+        snprintf(error, CBO_ERROR_SIZE, "%s: %s", file_path, strerror(errno));
+    }
+    return file;
+}
+
+// append concept as "<object indices> | <attribute indices>", the text output of cbo_v2
+bool writeConcept(const cbo_concept_t *concept, void *user_data) {
+    output_t *output = (output_t *) user_data;
+    size_t size = ((size_t) concept->object_count + concept->attribute_count) * RECORD_DIGITS + 3;
+    if (output->used + size > OUTPUT_BUFFER_SIZE) {
+        flushOutput(output);
+    }
+    if (size > OUTPUT_BUFFER_SIZE) {
+        // record larger than the buffer, formatted straight to the file
+        int i;
+        for (i = 0; i < concept->object_count; i++) {
+            fprintf(output->file, (i == 0) ? "%d" : " %d", concept->objects[i]);
+        }
+        fputs(" |", output->file);
+        for (i = 0; i < concept->attribute_count; i++) {
+            fprintf(output->file, " %d", concept->attributes[i]);
+        }
+        fputc('\n', output->file);
+        return !output->failed;
+    }
+    char *cursor = output->buffer + output->used;
+    cursor = writeIndices(cursor, concept->objects, concept->object_count, false);
+    *cursor++ = ' ';
+    *cursor++ = '|';
+    cursor = writeIndices(cursor, concept->attributes, concept->attribute_count, true);
+    *cursor++ = '\n';
+    output->used = cursor - output->buffer;
+    return !output->failed; // stop once the output is lost
+}
+
+// write buffered concept text to the file
+void flushOutput(output_t *output) {
+    if (output->used > 0 && fwrite(output->buffer, 1, output->used, output->file) != output->used) {
+        output->failed = true;
+    }
+    output->used = 0;
+}
+
+// write space separated decimal indices, leading space before the first one when asked
+char *writeIndices(char *cursor, const int *indices, int count, bool leading) {
+    int i;
+    char digits[RECORD_DIGITS];
+    for (i = 0; i < count; i++) {
+        unsigned int index = (unsigned int) indices[i];
+        int n = 0;
+        do {
+            digits[n++] = (char) ('0' + index % 10);
+            index /= 10;
+        } while (index != 0);
+        if (i > 0 || leading) {
+            *cursor++ = ' ';
+        }
+        while (n > 0) {
+            *cursor++ = digits[--n];
+        }
+    }
+    return cursor;
+}
+
+// seconds between two clock readings
+double elapsedSeconds(struct timespec *from, struct timespec *to) {
+    return (double) (to->tv_sec - from->tv_sec) + (double) (to->tv_nsec - from->tv_nsec) / 1e9;
+}
@@ -0,0 +1,532 @@
+// -----------------------------------------
+//
+// Close-by-One benchmark harness
+//
+// Runs cbo_v2 engines and modes over .cxt data sets with warmup and repeated trials, reporting wall time,
+// concepts per second and peak RSS, and writes the results as JSON. Given a baseline JSON written by an earlier
+// build, runs whose median wall time grew past the threshold are reported as regressions.
+//
+// -----------------------------------------
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <signal.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <sys/resource.h>
+#include <sys/utsname.h>
+
+#define MAX_ARGS 32 // arguments of one mode
+#define MAX_TRIALS 64 // trials of one run
+
+// define trial_t for hold measurements of one process run
+typedef struct {
+    bool ok; // process finished in time with a concept count
+    long concepts; // "Total Concepts" reported by the process
+    double wall_seconds; // process wall time, load and enumeration
+    double enumeration_seconds; // "execution time" reported by the process
+    long peak_rss_kb; // maximum resident set size of the process
+} trial_t;
+
+// define run_t for hold all trials of one data set under one mode
+typedef struct {
+    char *dataset;
+    char *mode;
+    trial_t trials[MAX_TRIALS];
+    int trial_count;
+    char *status; // ok, failed, timeout or mismatch
+    long concepts;
+    double median_wall_seconds;
+    double median_enumeration_seconds;
+    double concepts_per_second;
+    long peak_rss_kb;
+} run_t;
+
+char *binary_path = "./cbo_v2"; // holds benchmarked program
+int warmup_count = 1; // holds untimed runs before the trials
+int trial_count = 3; // holds timed runs
+int timeout_seconds = 600; // holds limit of one process run
+char *json_path = "bench.json"; // holds JSON result location
+char *baseline_path = NULL; // holds JSON of an earlier build, NULL when not compared
+double regression_threshold = 10.0; // holds allowed median wall time growth in percent
+
+// local functions
+void usage(char *program);
+
+int collectDatasets(char *path, char ***datasets, int count);
+
+int splitModes(char *list, char ***modes);
+
+trial_t runTrial(char *dataset, char *mode);
+
+void summarizeRun(run_t *run);
+
+int compareDoubles(const void *a, const void *b);
+
+void writeJson(run_t *runs, int run_count);
+
+void writeJsonString(FILE *file, const char *text);
+
+int compareBaseline(run_t *runs, int run_count);
+
+char *readJsonString(char *line, const char *key, char *text, size_t size);
+
+double elapsedSeconds(struct timespec *from, struct timespec *to);
+
+int main(int argc, char *argv[]) {
+    int opt;
+    char *mode_list = NULL;
+    while ((opt = getopt(argc, argv, "b:w:r:T:o:m:c:R:")) != -1) {
+        switch (opt) {
+            case 'b':
+                binary_path = optarg;
+                break;
+            case 'w':
+                warmup_count = atoi(optarg);
+                break;
+            case 'r':
+                trial_count = atoi(optarg);
+                if (trial_count < 1 || trial_count > MAX_TRIALS) {
+                    usage(argv[0]);
+                }
+                break;
+            case 'T':
+                timeout_seconds = atoi(optarg);
+                break;
+            case 'o':
+                json_path = optarg;
+                break;
+            case 'm':
+                mode_list = optarg;
+                break;
+            case 'c':
+                baseline_path = optarg;
+                break;
+            case 'R':
+                regression_threshold = atof(optarg);
+                break;
+            default:
+                usage(argv[0]);
+        }
+    }
+
+    // data sets, dataset/ unless given
+    char **datasets = NULL;
+    int dataset_count = 0;
+    int i, m, t;
+    if (optind >= argc) {
+        dataset_count = collectDatasets("dataset", &datasets, dataset_count);
+    }
+    for (i = optind; i < argc; i++) {
+        dataset_count = collectDatasets(argv[i], &datasets, dataset_count);
+    }
+    if (dataset_count == 0) {
+        fprintf(stderr, "no .cxt data sets found\n");
+        exit(EXIT_FAILURE);
+    }
+
+    // modes, every engine and the parallel mode on all cores unless given
+    char default_modes[128];
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    if (cores > 1) {
+        snprintf(default_modes, sizeof(default_modes),
+                 "-e cbo;-e bits;-e fcbo;-e sparse;-e inclose;-e bits -t %ld;-e batch -t %ld", cores, cores);
+    } else {
+        snprintf(default_modes, sizeof(default_modes), "-e cbo;-e bits;-e fcbo;-e sparse;-e inclose;-e batch");
+    }
+    char **modes = NULL;
+    int mode_count = splitModes(mode_list != NULL ? mode_list : default_modes, &modes);
+
+    run_t *runs = (run_t *) calloc((size_t) dataset_count * mode_count, sizeof(run_t));
+    int run_count = 0;
+    for (i = 0; i < dataset_count; i++) {
+        long expected = -1; // concept count every mode of the data set must agree on
+        for (m = 0; m < mode_count; m++) {
+            run_t *run = &runs[run_count++];
+            run->dataset = datasets[i];
+            run->mode = modes[m];
+            for (t = 0; t < warmup_count; t++) {
+                runTrial(run->dataset, run->mode);
+            }
+            for (t = 0; t < trial_count; t++) {
+                run->trials[run->trial_count++] = runTrial(run->dataset, run->mode);
+                if (!run->trials[t].ok) {
+                    break; // failed or timed out, do not repeat
+                }
+            }
+            summarizeRun(run);
+            if (strcmp(run->status, "ok") == 0) {
+                if (expected == -1) {
+                    expected = run->concepts;
+                } else if (expected != run->concepts) {
+                    run->status = "mismatch";
+                }
+            }
+            printf("%-40s %-20s %-8s concepts %10ld  wall %10.4f s  enum %10.4f s  %12.0f concepts/s  rss %8ld KB\n",
+                   run->dataset, run->mode, run->status, run->concepts, run->median_wall_seconds,
+                   run->median_enumeration_seconds, run->concepts_per_second, run->peak_rss_kb);
+            fflush(stdout);
+        }
+    }
+
+    writeJson(runs, run_count);
+    int regressions = 0;
+    if (baseline_path != NULL) {
+        regressions = compareBaseline(runs, run_count);
+    }
+    int mismatches = 0;
+    for (i = 0; i < run_count; i++) {
+        if (strcmp(runs[i].status, "mismatch") == 0) {
+            mismatches++;
+        }
+    }
+
+    for (i = 0; i < dataset_count; i++) {
+        free(datasets[i]);
+    }
+    free(datasets);
+    free(modes[0]);
+    free(modes);
+    free(runs);
+
+    return (regressions > 0 || mismatches > 0) ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+// print command line usage and exit
+void usage(char *program) {
+    fprintf(stderr, "usage: %s [-b binary] [-w warmup] [-r trials] [-T timeout] [-o bench.json] [-m modes]\n"
+                    "          [-c baseline.json] [-R percent] [dataset.cxt | directory ...]\n", program);
+    fprintf(stderr, "  -b  benchmarked program (default: ./cbo_v2)\n");
+    fprintf(stderr, "  -w  untimed warmup runs per data set and mode (default: 1)\n");
+    fprintf(stderr, "  -r  timed trials per data set and mode (default: 3)\n");
+    fprintf(stderr, "  -T  seconds before a run is killed (default: 600)\n");
+    fprintf(stderr, "  -o  JSON result file (default: bench.json)\n");
+    fprintf(stderr, "  -m  ';' separated program arguments per mode (default: every engine and -t <cores>)\n");
+    fprintf(stderr, "  -c  JSON result of an earlier build to compare median wall times with\n");
+    fprintf(stderr, "  -R  median wall time growth in percent reported as regression (default: 10)\n");
+    exit(EXIT_FAILURE);
+}
+
+// append path to data sets, every .cxt in name order when it is a directory
+int collectDatasets(char *path, char ***datasets, int count) {
+    struct stat info;
+    if (stat(path, &info) != 0) {
+        int err_num = errno;
+        fprintf(stderr, "Error opening file: %s: %s\n", path, strerror(err_num));
+        exit(EXIT_FAILURE);
+    }
+    if (!S_ISDIR(info.st_mode)) {
+        *datasets = (char **) realloc(*datasets, (count + 1) * sizeof(char *));
+        (*datasets)[count] = strdup(path);
+        return count + 1;
+    }
+    struct dirent **entries;
+    int entry_count = scandir(path, &entries, NULL, alphasort);
+    int e;
+    for (e = 0; e < entry_count; e++) {
+        size_t len = strlen(entries[e]->d_name);
+        if (len > 4 && strcmp(entries[e]->d_name + len - 4, ".cxt") == 0) {
+            *datasets = (char **) realloc(*datasets, (count + 1) * sizeof(char *));
+            (*datasets)[count] = (char *) malloc(strlen(path) + len + 2);
+            sprintf((*datasets)[count], "%s/%s", path, entries[e]->d_name);
+            count++;
+        }
+        free(entries[e]);
+    }
+    free(entries);
+    return count;
+}
+
+// split ';' separated modes, modes share one copy of the list
+int splitModes(char *list, char ***modes) {
+    char *copy = strdup(list);
+    char *cursor = copy;
+    int count = 0;
+    *modes = NULL;
+    while (cursor != NULL) {
+        char *next = strchr(cursor, ';');
+        if (next != NULL) {
+            *next++ = '\0';
+        }
+        *modes = (char **) realloc(*modes, (count + 1) * sizeof(char *));
+        (*modes)[count++] = cursor;
+        cursor = next;
+    }
+    return count;
+}
+
+// run program once on a data set, counting concepts only
+trial_t runTrial(char *dataset, char *mode) {
+    trial_t trial;
+    memset(&trial, 0, sizeof(trial));
+    trial.concepts = -1;
+
+    // program, mode arguments split on blanks, count sink, data set
+    char mode_copy[strlen(mode) + 1];
+    strcpy(mode_copy, mode);
+    char *args[MAX_ARGS + 4];
+    int arg_count = 0;
+    args[arg_count++] = binary_path;
+    char *token = strtok(mode_copy, " \t");
+    while (token != NULL && arg_count < MAX_ARGS) {
+        args[arg_count++] = token;
+        token = strtok(NULL, " \t");
+    }
+    args[arg_count++] = "-o";
+    args[arg_count++] = "count";
+    args[arg_count++] = dataset;
+    args[arg_count] = NULL;
+
+    int fds[2];
+    if (pipe(fds) != 0) {
+        perror("Error creating pipe");
+        exit(EXIT_FAILURE);
+    }
+    struct timespec wall_start, wall_end;
+    clock_gettime(CLOCK_MONOTONIC, &wall_start);
+    pid_t pid = fork();
+    if (pid == 0) {
+        dup2(fds[1], STDOUT_FILENO);
+        close(fds[0]);
+        close(fds[1]);
+        execv(binary_path, args);
+        perror("Error starting benchmarked program");
+        _exit(127);
+    }
+    close(fds[1]);
+
+    // collect output until the process closes it or runs out of time
+    char output[4096];
+    size_t used = 0;
+    bool timed_out = false;
+    fcntl(fds[0], F_SETFL, O_NONBLOCK);
+    while (true) {
+        ssize_t got = read(fds[0], output + used, sizeof(output) - 1 - used);
+        if (got > 0) {
+            used += got;
+            if (used == sizeof(output) - 1) {
+                // keep the tail, totals are printed last
+                memmove(output, output + used / 2, used - used / 2);
+                used -= used / 2;
+            }
+            continue;
+        }
+        if (got == 0) {
+            break;
+        }
+        clock_gettime(CLOCK_MONOTONIC, &wall_end);
+        if (elapsedSeconds(&wall_start, &wall_end) > timeout_seconds) {
+            kill(pid, SIGKILL);
+            timed_out = true;
+            break;
+        }
+        usleep(1000);
+    }
+    close(fds[0]);
+    output[used] = '\0';
+
+    int status;
+    struct rusage usage;
+    wait4(pid, &status, 0, &usage);
+    clock_gettime(CLOCK_MONOTONIC, &wall_end);
+    trial.wall_seconds = elapsedSeconds(&wall_start, &wall_end);
+    trial.peak_rss_kb = usage.ru_maxrss;
+
+    char *total = strstr(output, "Total Concepts : ");
+    char *execution = strstr(output, "execution time : ");
+    if (!timed_out && WIFEXITED(status) && WEXITSTATUS(status) == 0 && total != NULL && execution != NULL) {
+        trial.concepts = atol(total + strlen("Total Concepts : "));
+        trial.enumeration_seconds = atof(execution + strlen("execution time : "));
+        trial.ok = true;
+    } else {
+        trial.wall_seconds = timed_out ? -1 : trial.wall_seconds;
+    }
+    return trial;
+}
+
+// median times, throughput and peak memory of the trials
+void summarizeRun(run_t *run) {
+    double wall[MAX_TRIALS];
+    double enumeration[MAX_TRIALS];
+    int t;
+    run->status = "ok";
+    for (t = 0; t < run->trial_count; t++) {
+        if (!run->trials[t].ok) {
+            run->status = run->trials[t].wall_seconds < 0 ? "timeout" : "failed";
+            run->concepts = -1;
+            return;
+        }
+        wall[t] = run->trials[t].wall_seconds;
+        enumeration[t] = run->trials[t].enumeration_seconds;
+        if (run->trials[t].peak_rss_kb > run->peak_rss_kb) {
+            run->peak_rss_kb = run->trials[t].peak_rss_kb;
+        }
+    }
+    qsort(wall, run->trial_count, sizeof(double), compareDoubles);
+    qsort(enumeration, run->trial_count, sizeof(double), compareDoubles);
+    run->concepts = run->trials[0].concepts;
+    run->median_wall_seconds = wall[run->trial_count / 2];
+    run->median_enumeration_seconds = enumeration[run->trial_count / 2];
+    run->concepts_per_second = run->median_enumeration_seconds > 0
+                               ? run->concepts / run->median_enumeration_seconds : 0;
+}
+
+// ascending order of doubles
+int compareDoubles(const void *a, const void *b) {
+    double x = *(const double *) a;
+    double y = *(const double *) b;
+    return (x > y) - (x < y);
+}
+
+// write results, one run object per line so baselines are read back line by line
+void writeJson(run_t *runs, int run_count) {
+    FILE *file = fopen(json_path, "w");
+    int i, t;
+    if (file == NULL) {
+        int err_num = errno;
+        fprintf(stderr, "Error writing file: %s: %s\n", json_path, strerror(err_num));
+        exit(EXIT_FAILURE);
+    }
+    struct utsname host;
+    uname(&host);
+    char host_name[sizeof(host.nodename) + sizeof(host.sysname) + sizeof(host.machine) + 2];
+    snprintf(host_name, sizeof(host_name), "%s %s %s", host.nodename, host.sysname, host.machine);
+    fprintf(file, "{\n  \"binary\": ");
+    writeJsonString(file, binary_path);
+    fprintf(file, ",\n  \"host\": ");
+    writeJsonString(file, host_name);
+    fprintf(file, ",\n  \"timestamp\": %ld,\n  \"warmup\": %d,\n  \"trials\": %d,\n  \"runs\": [\n", (long) time(NULL),
+            warmup_count, trial_count);
+    for (i = 0; i < run_count; i++) {
+        run_t *run = &runs[i];
+        fprintf(file, "    {\"dataset\": ");
+        writeJsonString(file, run->dataset);
+        fprintf(file, ", \"mode\": ");
+        writeJsonString(file, run->mode);
+        fprintf(file, ", \"status\": \"%s\", \"concepts\": %ld, "
+                      "\"median_wall_seconds\": %.6f, \"median_enumeration_seconds\": %.6f, "
+                      "\"concepts_per_second\": %.1f, \"peak_rss_kb\": %ld, \"wall_seconds\": [",
+                run->status, run->concepts, run->median_wall_seconds, run->median_enumeration_seconds,
+                run->concepts_per_second, run->peak_rss_kb);
+        for (t = 0; t < run->trial_count; t++) {
+            fprintf(file, "%s%.6f", t == 0 ? "" : ", ", run->trials[t].wall_seconds);
+        }
+        fprintf(file, "]}%s\n", i + 1 < run_count ? "," : "");
+    }
+    fprintf(file, "  ]\n}\n");
+    fclose(file);
+}
+
+// write text as a quoted JSON string, quotes, backslashes and control characters escaped
+void writeJsonString(FILE *file, const char *text) {
+    const unsigned char *c;
+    fputc('"', file);
+    for (c = (const unsigned char *) text; *c != '\0'; c++) {
+        if (*c == '"' || *c == '\\') {
+            fprintf(file, "\\%c", *c);
+        } else if (*c < 0x20) {
+            fprintf(file, "\\u%04x", *c);
+        } else {
+            fputc(*c, file);
+        }
+    }
+    fputc('"', file);
+}
+
+// report runs slower than the same data set and mode of the baseline, returns regression count
+int compareBaseline(run_t *runs, int run_count) {
+    FILE *file = fopen(baseline_path, "r");
+    char *line = NULL;
+    size_t len = 0;
+    int regressions = 0;
+    int i;
+    if (file == NULL) {
+        int err_num = errno;
+        fprintf(stderr, "Error opening file: %s: %s\n", baseline_path, strerror(err_num));
+        exit(EXIT_FAILURE);
+    }
+    printf("\n~~~ Compared with %s ~~~\n\n", baseline_path);
+    while (getline(&line, &len, file) != -1) {
+        char dataset[4096], mode[4096];
+        double baseline_seconds;
+        char *median = strstr(line, "\"median_wall_seconds\": ");
+        if (readJsonString(line, "\"dataset\": ", dataset, sizeof(dataset)) == NULL
+            || readJsonString(line, "\"mode\": ", mode, sizeof(mode)) == NULL
+            || median == NULL || strstr(line, "\"status\": \"ok\"") == NULL) {
+            continue;
+        }
+        baseline_seconds = atof(median + strlen("\"median_wall_seconds\": "));
+        for (i = 0; i < run_count; i++) {
+            run_t *run = &runs[i];
+            if (strcmp(run->dataset, dataset) != 0 || strcmp(run->mode, mode) != 0 || strcmp(run->status, "ok") != 0) {
+                continue;
+            }
+            double change = baseline_seconds > 0
+                            ? (run->median_wall_seconds - baseline_seconds) * 100.0 / baseline_seconds : 0;
+            bool regressed = change > regression_threshold;
+            printf("%-40s %-20s %10.4f s -> %10.4f s  %+7.1f %%%s\n", dataset, mode, baseline_seconds,
+                   run->median_wall_seconds, change, regressed ? "  REGRESSION" : "");
+            regressions += regressed;
+        }
+    }
+    free(line);
+    fclose(file);
+    printf("\n%d regression(s) above %.1f %%\n", regressions, regression_threshold);
+    return regressions;
+}
+
+/**
+ * read the JSON string following key in a run line written by writeJsonString, escapes undone
+ *
+ * input :  1. run line
+ *          2. key with its colon and space, the string starts right after it
+ *          3. buffer for the string
+ *          4. buffer size
+ *
+ * returns text, NULL when the key is missing or the string is unterminated or too long
+ */
+char *readJsonString(char *line, const char *key, char *text, size_t size) {
+    char *c = strstr(line, key);
+    size_t length = 0;
+    if (c == NULL || c[strlen(key)] != '"') {
+        return NULL;
+    }
+    for (c += strlen(key) + 1; *c != '"'; c++) {
+        char value = *c;
+        if (value == '\0' || length + 1 == size) {
+            return NULL;
+        }
+        if (value == '\\') {
+            c++;
+            if (*c == 'u') {
+                unsigned int code;
+                if (sscanf(c + 1, "%4x", &code) != 1 || code > 0xff) {
+                    return NULL;
+                }
+                value = (char) code;
+                c += 4;
+            } else if (*c == 'n' || *c == 't' || *c == 'r' || *c == 'b' || *c == 'f') {
+                value = (*c == 'n') ? '\n' : (*c == 't') ? '\t' : (*c == 'r') ? '\r' : (*c == 'b') ? '\b' : '\f';
+            } else if (*c == '\0') {
+                return NULL;
+            } else {
+                value = *c; // quote, backslash or slash
+            }
+        }
+        text[length++] = value;
+    }
+    text[length] = '\0';
+    return text;
+}
+
+// seconds between two monotonic clock readings
+double elapsedSeconds(struct timespec *from, struct timespec *to) {
+    return (double) (to->tv_sec - from->tv_sec) + (double) (to->tv_nsec - from->tv_nsec) / 1e9;
+}
@@ -0,0 +1,243 @@
+// -----------------------------------------
+//
+// Close-by-One shard merge
+//
+// Combines the concept outputs of cbo_v2 shard runs (-s index/count) into one output. Text and binary concept
+// streams are accepted, all inputs of one merge in the same format and, for binary streams, of the same context.
+// Reports concepts per shard and in total, and optionally checks that no concept is output by two shards.
+//
+// -----------------------------------------
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <errno.h>
+#include <unistd.h>
+
+#define CONCEPT_STREAM_MAGIC "CBOS"
+#define CONCEPT_STREAM_VERSION 1
+
+// define concept_stream_header_t for hold binary concept stream header, as written by cbo_v2 -o binary
+typedef struct {
+    char magic[4];
+    uint32_t version;
+    uint32_t objects;
+    uint32_t attributes;
+} concept_stream_header_t;
+
+char *output_path = NULL; // holds merged output location, nothing written when NULL
+bool check_unique = false; // holds whether concepts output by several shards are reported
+FILE *output = NULL; // holds merged output
+bool binary = false; // holds input format, binary concept streams or text
+concept_stream_header_t merged_header; // holds header of the first binary input
+uint64_t *hashes = NULL; // holds hash of every concept when checked
+long hash_count = 0;
+long hash_capacity = 0;
+
+// local functions
+void usage(char *program);
+
+long mergeText(FILE *file, char *file_path);
+
+long mergeBinary(FILE *file, char *file_path);
+
+void recordHash(void *data, size_t size);
+
+long countDuplicates(void);
+
+int compareHashes(const void *a, const void *b);
+
+void failRead(char *file_path);
+
+int main(int argc, char *argv[]) {
+    int opt, i;
+    while ((opt = getopt(argc, argv, "f:u")) != -1) {
+        switch (opt) {
+            case 'f':
+                output_path = optarg;
+                break;
+            case 'u':
+                check_unique = true;
+                break;
+            default:
+                usage(argv[0]);
+        }
+    }
+    if (optind >= argc) {
+        usage(argv[0]);
+    }
+    if (output_path != NULL && (output = fopen(output_path, "wb")) == NULL) {
+        int err_num = errno;
+        fprintf(stderr, "Error opening file: %s: %s\n", output_path, strerror(err_num));
+        exit(EXIT_FAILURE);
+    }
+
+    long total = 0;
+    for (i = optind; i < argc; i++) {
+        FILE *file = fopen(argv[i], "rb");
+        if (file == NULL) {
+            int err_num = errno;
+            fprintf(stderr, "Error opening file: %s: %s\n", argv[i], strerror(err_num));
+            exit(EXIT_FAILURE);
+        }
+        // 1. format from the first input, by the stream magic
+        char magic[4] = {0};
+        size_t got = fread(magic, 1, sizeof(magic), file);
+        bool is_binary = got == sizeof(magic) && memcmp(magic, CONCEPT_STREAM_MAGIC, sizeof(magic)) == 0;
+        rewind(file);
+        if (i == optind) {
+            binary = is_binary;
+        } else if (is_binary != binary) {
+            fprintf(stderr, "Error merging: %s: text and binary concept streams mixed\n", argv[i]);
+            exit(EXIT_FAILURE);
+        }
+        // 2. copy concepts
+        long concepts = binary ? mergeBinary(file, argv[i]) : mergeText(file, argv[i]);
+        fclose(file);
+        printf("%s : %ld concepts\n", argv[i], concepts);
+        total += concepts;
+    }
+    if (output != NULL && fclose(output) != 0) {
+        int err_num = errno;
+        fprintf(stderr, "Error writing file: %s: %s\n", output_path, strerror(err_num));
+        exit(EXIT_FAILURE);
+    }
+
+    printf("\nTotal Concepts : %ld\n\n", total);
+    if (check_unique) {
+        long duplicates = countDuplicates();
+        printf("duplicate concepts : %ld\n\n", duplicates);
+        free(hashes);
+        if (duplicates > 0) {
+            return EXIT_FAILURE;
+        }
+    }
+    return 0;
+}
+
+// print command line usage and exit
+void usage(char *program) {
+    fprintf(stderr, "usage: %s [-f output] [-u] <shard output>...\n", program);
+    fprintf(stderr, "  -f  merged concept output (default: counts only)\n");
+    fprintf(stderr, "  -u  report concepts output by more than one shard, exits with failure when found\n");
+    exit(EXIT_FAILURE);
+}
+
+// copy text concept lines, "<objects> | <attributes>", returns concepts copied
+long mergeText(FILE *file, char *file_path) {
+    char *line = NULL;
+    size_t capacity = 0;
+    ssize_t length;
+    long concepts = 0;
+    while ((length = getline(&line, &capacity, file)) != -1) {
+        if (memchr(line, '|', length) == NULL) {
+            continue; // not a concept line
+        }
+        if (output != NULL) {
+            fwrite(line, 1, length, output);
+        }
+        if (check_unique) {
+            recordHash(line, line[length - 1] == '\n' ? length - 1 : length);
+        }
+        concepts++;
+    }
+    if (ferror(file)) {
+        failRead(file_path);
+    }
+    free(line);
+    return concepts;
+}
+
+// copy binary concept records after checking the header, returns concepts copied
+long mergeBinary(FILE *file, char *file_path) {
+    concept_stream_header_t header;
+    if (fread(&header, sizeof(header), 1, file) != 1) {
+        failRead(file_path);
+    }
+    if (header.version != CONCEPT_STREAM_VERSION) {
+        fprintf(stderr, "Error merging: %s: unsupported stream version %u\n", file_path, header.version);
+        exit(EXIT_FAILURE);
+    }
+    if (hash_count == 0 && merged_header.version == 0) {
+        // first input, its header starts the merged stream
+        merged_header = header;
+        if (output != NULL) {
+            fwrite(&header, sizeof(header), 1, output);
+        }
+    } else if (header.objects != merged_header.objects || header.attributes != merged_header.attributes) {
+        fprintf(stderr, "Error merging: %s: stream of a %u x %u context, expected %u x %u\n", file_path,
+                header.objects, header.attributes, merged_header.objects, merged_header.attributes);
+        exit(EXIT_FAILURE);
+    }
+    size_t capacity = ((size_t) header.objects + header.attributes + 2) * sizeof(uint32_t);
+    uint32_t *record = (uint32_t *) malloc(capacity);
+    long concepts = 0;
+    while (fread(record, sizeof(uint32_t), 2, file) == 2) {
+        // extent size, intent size, then the indices
+        if (record[0] > header.objects || record[1] > header.attributes) {
+            fprintf(stderr, "Error merging: %s: corrupt concept record %ld\n", file_path, concepts);
+            exit(EXIT_FAILURE);
+        }
+        size_t indices = (size_t) record[0] + record[1];
+        if (fread(record + 2, sizeof(uint32_t), indices, file) != indices) {
+            failRead(file_path);
+        }
+        if (output != NULL) {
+            fwrite(record, sizeof(uint32_t), indices + 2, output);
+        }
+        if (check_unique) {
+            recordHash(record, (indices + 2) * sizeof(uint32_t));
+        }
+        concepts++;
+    }
+    if (ferror(file)) {
+        failRead(file_path);
+    }
+    free(record);
+    return concepts;
+}
+
+// remember hash of one concept record
+void recordHash(void *data, size_t size) {
+    size_t i;
+    unsigned char *bytes = (unsigned char *) data;
+    uint64_t hash = 1469598103934665603ULL;
+    for (i = 0; i < size; i++) {
+        hash = (hash ^ bytes[i]) * 1099511628211ULL;
+    }
+    if (hash_count == hash_capacity) {
+        hash_capacity = (hash_capacity == 0) ? 4096 : 2 * hash_capacity;
+        hashes = (uint64_t *) realloc(hashes, hash_capacity * sizeof(uint64_t));
+        if (hashes == NULL) {
+            fprintf(stderr, "Error allocating %ld concept hashes\n", hash_capacity);
+            exit(EXIT_FAILURE);
+        }
+    }
+    hashes[hash_count++] = hash;
+}
+
+// count concepts whose hash was seen before, after sorting the hashes
+long countDuplicates(void) {
+    long i;
+    long duplicates = 0;
+    qsort(hashes, hash_count, sizeof(uint64_t), compareHashes);
+    for (i = 1; i < hash_count; i++) {
+        duplicates += hashes[i] == hashes[i - 1];
+    }
+    return duplicates;
+}
+
+// order of two hashes for qsort
+int compareHashes(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *) a;
+    uint64_t y = *(const uint64_t *) b;
+    return (x > y) - (x < y);
+}
+
+// report read failure and exit
+void failRead(char *file_path) {
+    fprintf(stderr, "Error reading file: %s: truncated or unreadable\n", file_path);
+    exit(EXIT_FAILURE);
+}
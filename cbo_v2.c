@@ -18,319 +18,4782 @@
 #include <stdbool.h>
 #include <errno.h>
 #include <time.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <signal.h>
+#include <math.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
 
-clock_t start, end;
+#define WORD_BITS 64 // bits held by one packed bitset word
+#define WORDS_FOR(n) (((n) + WORD_BITS - 1) / WORD_BITS) // words needed to hold n bits
+#define BIT_WORD(i) ((i) / WORD_BITS) // word holding bit i
+#define BIT_MASK(i) (1ULL << ((i) % WORD_BITS)) // mask of bit i inside its word
+
+// enumeration engines selectable on the command line
+typedef enum {
+    ENGINE_CBO, // original Close-by-One on '0'/'1' char arrays
+    ENGINE_BITS, // Close-by-One on packed 64-bit bitsets
+    ENGINE_FCBO, // Fast Close-by-One on packed 64-bit bitsets
+    ENGINE_SPARSE, // Close-by-One switching to sorted object id lists on small extents
+    ENGINE_INCLOSE, // In-Close3 on packed 64-bit bitsets
+    ENGINE_BATCH // Close-by-One evaluating batches of candidate extensions data-parallel
+} engine_t;
+
+#define BINARY_CONTEXT_MAGIC "CBOC" // leading bytes of a binary context file
+#define BINARY_CONTEXT_VERSION 1 // binary context layout version
+
+// define binary_context_header_t for hold binary context header, followed by object rows of packed attribute words
+typedef struct {
+    char magic[4];
+    uint32_t version;
+    uint32_t objects;
+    uint32_t attributes;
+} binary_context_header_t;
+
+#define CONCEPT_STREAM_MAGIC "CBOS" // leading bytes of a binary concept stream
+#define CONCEPT_STREAM_VERSION 1 // binary concept stream layout version
+#define LATTICE_MAGIC "CBOL" // leading bytes of a lattice file
+#define LATTICE_VERSION 1 // lattice file layout version
+#define SHARD_ESTIMATE_DEPTH 4 // levels of a root branch counted for its cost estimate
+#define BATCH_CANDIDATES 4096 // candidate extensions evaluated per round of the batch engine
+#define BATCH_CHUNK 16 // candidates a thread of the batch engine claims at a time
+#define CHECKPOINT_MAGIC "CBOK" // leading bytes of a checkpoint file
+#define CHECKPOINT_VERSION 1 // checkpoint file layout version
+#define CHECKPOINT_TICKS 1024 // stack steps between clock readings of the checkpoint timer
+#define ESTIMATE_Z 1.96 // normal quantile of the 95% intervals of the estimator
+#define ESTIMATE_MIN_EFFECTIVE 30 // effective paths below which the estimator gives no interval
+#define ESTIMATE_MIN_SHARE 0.05 // share of effective paths below which a few paths dominate the estimates
+#define OUTPUT_BUFFER_SIZE (1 << 20) // bytes of one output buffer handed to the writer
+
+// define concept_stream_header_t for hold binary concept stream header, followed by one record per concept:
+// extent size, intent size, extent object indices, intent attribute indices, all 32-bit words
+typedef struct {
+    char magic[4];
+    uint32_t version;
+    uint32_t objects;
+    uint32_t attributes;
+} concept_stream_header_t;
+
+// define checkpoint_header_t for hold checkpoint file header, followed by the next attribute of every stack frame of
+// the bits engine as 32-bit words, the concepts of the frames are recomputed from them on resume
+typedef struct {
+    char magic[4];
+    uint32_t version;
+    uint32_t objects; // enumerated context, after preprocessing
+    uint32_t attributes;
+    uint64_t context_hash; // hash of the packed object rows
+    int32_t sink_kind; // options the enumeration and its output depend on
+    int32_t min_support;
+    int32_t shard_index;
+    int32_t shard_count;
+    uint64_t concept_count; // concepts output before the checkpoint
+    uint64_t output_offset; // bytes of concept output holding them
+    uint32_t frames; // stack depth + 1
+    uint32_t reserved;
+} checkpoint_header_t;
+
+// define kernels_t for hold one variant of the bitset kernels, picked at startup from the CPU features
+typedef struct {
+    const char *name;
+    bool (*supported)(void); // variant runs on this CPU
+    void (*intersect)(uint64_t *result, uint64_t *a, uint64_t *b, int words); // result = a AND b
+    bool (*subset)(uint64_t *a, uint64_t *b, int words); // every bit of a also in b
+    long (*popcount)(uint64_t *a, int words); // bits set in a
+} kernels_t;
+
+// define lattice_t for hold enumerated concepts in packed arenas, their Close-by-One tree and cover relation
+typedef struct {
+    long count; // concepts stored
+    long capacity; // concepts the arenas hold before growing
+    uint64_t *extents; // object_words words per concept
+    uint64_t *intents; // attribute_words words per concept
+    long *parents; // Close-by-One tree parent per concept, -1 for the root
+    long *lower_start; // count + 1 offsets into lower
+    long *lower; // lower covers, concepts with the next larger intents
+    long *upper_start; // count + 1 offsets into upper
+    long *upper; // upper covers, concepts with the next smaller intents
+    long edges; // cover pairs
+} lattice_t;
+
+// define lattice_header_t for hold lattice file header, followed by parents, extents and intents of every concept as
+// packed 64-bit words, then lower and upper cover offsets and targets
+typedef struct {
+    char magic[4];
+    uint32_t version;
+    uint32_t objects;
+    uint32_t attributes;
+    uint64_t concepts;
+    uint64_t edges;
+} lattice_header_t;
+
+// attribute orders applied by the preprocessing stage
+typedef enum {
+    ORDER_NONE, // keep file order
+    ORDER_ASCENDING, // ascending support
+    ORDER_DESCENDING // descending support
+} order_t;
+
+// concept output sinks selectable on the command line
+typedef enum {
+    SINK_COUNT, // count concepts only
+    SINK_TEXT, // one line per concept, extent and intent index lists
+    SINK_BINARY // binary concept stream
+} sink_kind_t;
+
+// define output_buffer_t for hold encoded concepts on the way to the writer thread
+typedef struct output_buffer {
+    char *data;
+    size_t used;
+    struct output_buffer *next;
+} output_buffer_t;
+
+// define sink_t for hold concept output state of one thread
+typedef struct sink {
+    void (*emit)(struct sink *sink, uint64_t *extent, uint64_t *intent); // output one concept
+    long concept_count; // concepts emitted through this sink
+    output_buffer_t *buffer; // buffer being filled, NULL for the count sink
+    uint64_t *mapped_extent; // concept mapped back to the loaded context, NULL without preprocessing
+    uint64_t *mapped_intent;
+    uint64_t digest; // order independent hash of the emitted concepts, kernel self-check only
+} sink_t;
+
+// define writer_t for hold the background writer, draining full buffers in submission order
+typedef struct {
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t queued; // buffer queued or writer stopping
+    pthread_cond_t released; // buffer returned to the free list
+    output_buffer_t *head; // queued buffers, oldest first
+    output_buffer_t *tail;
+    output_buffer_t *free_list; // empty buffers ready to fill
+    bool writing; // buffer taken from the queue and not returned yet
+    bool stopping;
+    FILE *file;
+} writer_t;
+
+#ifdef CBO_STATS
+// instrumented functions, calls and cycles are kept per kind
+typedef enum {
+    STAT_EXTENT, // makeExtent
+    STAT_INTENT, // makeIntentBits
+    STAT_CANONICITY, // failingAttributeBits
+    STAT_FUSED, // closeAndTest and closeOrFailingBits, closure fused with canonicity test
+    STAT_KINDS
+} stat_kind_t;
+
+// define stats_t for hold hot path counters of one thread, merged at exit
+typedef struct stats {
+    uint64_t calls[STAT_KINDS];
+    uint64_t cycles[STAT_KINDS];
+    uint64_t canonicity_failures; // canonicity tests and fused closures rejecting the candidate
+    uint64_t inherited_skips; // closures skipped on a failed closure inherited by Fast Close-by-One
+    uint64_t concepts;
+    uint64_t extent_objects; // objects summed over the extents of all concepts
+    uint64_t *depth_concepts; // per depth of the Close-by-One tree, attribute_size + 2 entries each
+    uint64_t *depth_closures;
+    uint64_t *depth_failures;
+    uint64_t *depth_extent_objects;
+    struct stats *next;
+} stats_t;
+
+#define STATS_COUNT(field) (threadStats()->field++)
+#define STATS_DEPTH(d) (stats_depth = stats_base_depth + (d))
+#define STATS_BASE_DEPTH(d) (stats_base_depth = (d))
+#define STATS_PUSH() (stats_depth++)
+#define STATS_POP() (stats_depth--)
+#define STATS_START(timer) uint64_t timer = readCycles()
+#define STATS_STOP(timer, kind) recordCall(kind, readCycles() - (timer))
+#define STATS_FAILURE() recordFailure()
+#define STATS_CONCEPT(extent) recordConcept(extent)
+#else
+#define STATS_COUNT(field) ((void) 0)
+#define STATS_DEPTH(d) ((void) 0)
+#define STATS_BASE_DEPTH(d) ((void) 0)
+#define STATS_PUSH() ((void) 0)
+#define STATS_POP() ((void) 0)
+#define STATS_START(timer) ((void) 0)
+#define STATS_STOP(timer, kind) ((void) 0)
+#define STATS_FAILURE() ((void) 0)
+#define STATS_CONCEPT(extent) ((void) 0)
+#endif
+
+clock_t start, end; // enumeration cpu time, all threads
+struct timespec wall_start, wall_end; // enumeration wall time
 extern int err_no; // globally holds the error no
 int data_size; // holds the data set size
 int attribute_size; // holds the attribute size
 char *cross_table; // holds data set of cross table from .cxt file
-int concept_count = 0; // holds generated concepts count
+long concept_count = 0; // holds generated concepts count
+int object_words; // holds 64-bit words per extent bitset
+int attribute_words; // holds 64-bit words per intent bitset
+uint64_t *bit_columns; // holds cross table by attribute, each column packed as object bitset
+uint64_t *bit_rows; // holds cross table by object, each row packed as attribute bitset
+engine_t engine = ENGINE_CBO; // holds selected enumeration engine
+int thread_count = 1; // holds worker thread count, parallel mode when above one
+int split_depth = 2; // holds recursion depth above which branches are spawned as tasks
+
+// define frame_t for hold one level of the explicit Close-by-One stack
+typedef struct {
+    uint64_t *extent; // concept objects, own storage or a closure slot of the parent level
+    uint64_t *intent; // concept attributes, own storage or a closure slot of the parent level
+    int attr_index; // next attribute to extend with
+    uint64_t *extents; // Fast Close-by-One closures of this level, one extent slot per attribute
+    uint64_t *intents; // Fast Close-by-One closures of this level, one intent slot per attribute
+    int *failing; // attribute that failed the canonicity test per attribute handed to the children, -1 when none
+    int *queue; // Fast Close-by-One and In-Close canonical children, by attribute
+    int queued; // canonical children found
+    int next; // next canonical child to descend
+    int *tids; // sparse engine extent as sorted object ids, valid when sparse
+    int tid_count; // sparse engine extent size
+    bool sparse; // sparse engine extent held as object ids, its bitset holds exactly those bits
+    long id; // concept id in the lattice store, -1 when not stored
+} frame_t;
+
+// define arena_t for hold stack frames indexed by depth, buffers of a depth allocated on first use only
+typedef struct {
+    frame_t *frames; // attribute_size + 1 frames, each level adds at least one attribute
+    int allocated; // depths with buffers allocated
+    int *no_failing; // empty failing attributes inherited by the root
+    bool sharded; // depth 0 holds the root concept, its branches are split across shards
+} arena_t;
+
+// define task_t for hold one pending branch of the Close-by-One tree
+typedef struct {
+    uint64_t *extent; // concept objects, points into the same allocation
+    uint64_t *intent; // concept attributes, points into the same allocation
+    int attr_index; // next attribute to extend with
+    int depth; // depth of the concept in the Close-by-One tree
+} task_t;
+
+// define deque_t for hold tasks of one worker, owner works on the tail while thieves take the head
+typedef struct {
+    task_t **tasks;
+    int head;
+    int tail;
+    int capacity;
+    pthread_mutex_t lock;
+} deque_t;
+
+// define worker_t for hold per thread state of the parallel mode
+typedef struct {
+    int id;
+    pthread_t thread;
+    deque_t deque;
+    sink_t sink; // concept output of this worker, counts merged at the end
+    arena_t arena; // stack frames of the branches run serially by this worker
+    unsigned int seed; // victim selection seed
+} worker_t;
+
+// define implications_t for hold implications of the stem base found so far, indexed for LinClosure
+typedef struct {
+    long count; // implications
+    long capacity;
+    uint64_t *premises; // attribute_words words per implication
+    uint64_t *conclusions; // closure of the premise, attribute_words words per implication
+    int *premise_sizes; // attributes per premise
+    int *missing; // premise attributes not in the set being closed, per implication
+    long *stamps; // closure that last set missing, older counts are stale
+    long closures; // closures run, stamp of the current one
+    long **by_attribute; // per attribute the implications whose premise holds it
+    long *by_attribute_count;
+    long *by_attribute_capacity;
+    int *pending; // attributes added to the set being closed, not counted down yet
+} implications_t;
+
+// passes of the batch engine over one batch
+typedef enum {
+    BATCH_EVALUATE, // extents, closures and canonicity tests
+    BATCH_MOVE // canonical children onto the stack
+} batch_pass_t;
+
+// define frontier_t for hold pending concepts and the batch of candidate extensions of the batch engine
+typedef struct {
+    uint64_t *extents; // pending concepts as a stack, object_words words each
+    uint64_t *intents; // attribute_words words each
+    int *attr_index; // next attribute to extend with, per pending concept
+    int *depth; // depth in the Close-by-One tree, per pending concept
+    long count; // pending concepts
+    long capacity; // pending concepts the stack holds before growing
+    long *candidate_node; // pending concept extended by the candidate
+    int *candidate_attr; // attribute added by the candidate
+    int *candidate_depth; // depth of the child
+    long *child_slot; // stack slot of the canonical child, -1 when not canonical
+    uint64_t *child_extents; // closure of every canonical candidate
+    uint64_t *child_intents;
+    uint64_t *scratch_extents; // closure being tested, per thread
+    uint64_t *scratch_intents;
+    long candidates; // candidates in the batch
+    long candidate_capacity;
+    batch_pass_t pass; // pass the team runs
+    atomic_long next_candidate; // first candidate of the next chunk to claim
+    pthread_barrier_t start; // team starts a pass or stops
+    pthread_barrier_t done; // team finished the pass
+    bool stopping;
+} frontier_t;
+
+worker_t *workers; // holds parallel mode workers
+atomic_long pending_tasks; // holds spawned tasks not finished yet
+pthread_mutex_t idle_lock = PTHREAD_MUTEX_INITIALIZER; // held by a worker from its last sweep until it parks
+pthread_cond_t idle_wake = PTHREAD_COND_INITIALIZER; // holds parked workers, woken by a push or the last task
+atomic_int idle_workers; // holds workers sweeping under idle_lock or parked on idle_wake
+_Thread_local worker_t *current_worker = NULL; // holds worker of the calling thread, NULL when serial
+bool verbose = false; // holds whether the loaded cross table is printed
+char *cache_path = NULL; // holds binary context cache location, NULL when not cached
+sink_kind_t sink_kind = SINK_TEXT; // holds selected concept output sink
+char *output_path = NULL; // holds concept output location, stdout when NULL
+sink_t main_sink; // holds concept output of the serial engines
+arena_t main_arena; // holds stack frames of the serial engines
+writer_t writer; // holds background writer of the buffered sinks
+char *stats_path = NULL; // holds instrumentation JSON location, NULL when not written
+bool reduce_context = false; // holds whether objects and attributes are clarified and reducible attributes removed
+order_t attribute_order = ORDER_NONE; // holds attribute order applied before enumeration
+bool preprocessed = false; // holds whether concepts are mapped back to the loaded context
+int output_data_size; // holds object count of the loaded context, concepts are output against it
+int output_attribute_size; // holds attribute count of the loaded context
+int *object_class_start; // holds per reduced object the first of its loaded objects, reduced object count + 1 entries
+int *object_class_members; // holds loaded objects grouped by reduced object
+int attribute_classes; // holds clarified attribute count
+int *attribute_class_start; // holds per clarified attribute the first of its loaded attributes
+int *attribute_class_members; // holds loaded attributes grouped by clarified attribute
+int *attribute_class_reduced; // holds per clarified attribute its reduced attribute, -1 when reducible
+uint64_t *attribute_class_required; // holds per clarified attribute the reduced attributes implying it when reducible
+char *kernel_name = "auto"; // holds requested kernel variant, auto picks the widest supported, check runs all
+kernels_t kernels; // holds bitset kernels in use
+double sparse_density = -1; // holds extent density below which the sparse engine uses object ids, negative for auto
+int sparse_limit; // holds extent size below which the sparse engine uses object ids
+int *row_start; // holds per object the first of its attribute ids, data_size + 1 entries
+int *row_attributes; // holds sorted attribute ids of every object
+char *lattice_path = NULL; // holds lattice file location, concepts are stored only when set
+lattice_t lattice; // holds concepts and cover relation of the serial bitset engines
+int min_support = 0; // holds minimum extent size of enumerated concepts, branches below it are cut
+int shard_index = 0; // holds shard run by this process, the root concept belongs to shard 0
+int shard_count = 1; // holds shards the branches of the root concept are split across
+int *branch_shard; // holds per attribute the shard owning the root branch through it, -1 when no branch
+frontier_t frontier; // holds stack and batch buffers of the batch engine
+char *checkpoint_path = NULL; // holds checkpoint location, the serial bits engine checkpoints and resumes when set
+double checkpoint_interval = 5; // holds seconds between checkpoints
+uint64_t checkpoint_context_hash; // holds hash of the enumerated context, checkpoints of another context are refused
+int checkpoint_ticks = 0; // holds stack steps since the checkpoint timer was last read
+struct timespec checkpoint_time; // holds time of the last checkpoint
+volatile sig_atomic_t interrupted = 0; // holds whether SIGINT or SIGTERM asked to checkpoint and stop
+bool resuming = false; // holds whether the run continues from a checkpoint
+checkpoint_header_t resume_header; // holds checkpoint the run continues from
+uint32_t *resume_attr_index; // holds next attribute of every stack frame of the checkpoint
+char *update_path = NULL; // holds concept stream of the first objects, the objects after them are added to it
+bool verify_update = false; // holds whether the updated concepts are compared with a full enumeration
+bool implication_basis = false; // holds whether the stem base is computed instead of the concepts
+double estimate_budget = 0; // holds seconds spent sampling tree paths to estimate the run, 0 when enumerating
+#ifdef CBO_STATS
+stats_t *all_stats = NULL; // holds counters of every thread
+pthread_mutex_t stats_lock = PTHREAD_MUTEX_INITIALIZER; // guards all_stats
+_Thread_local stats_t *thread_stats = NULL; // holds counters of the calling thread
+_Thread_local int stats_depth = 0; // holds depth of the concept being processed or closed
+_Thread_local int stats_base_depth = 0; // holds depth of the concept a serial branch starts from
+#endif
+
+// local functions
+void loadContext(char *file_path);
+
+void loadData(char *file_path);
+
+bool nextLine(char **cursor, char *end, char **line, size_t *len);
+
+void printContext(void);
+
+bool isBinaryContext(char *file_path);
+
+void loadBinaryContext(char *file_path);
+
+long findPaddingRow(uint64_t *rows, int objects, int attributes);
+
+void writeBinaryContext(char *file_path);
+
+void buildInitialConcept(char *obj, char *attr);
+
+void computeConceptFrom(char *obj, char *attr, int attr_index);
+
+void processConcept(char *obj, char *attr);
+
+bool checkAttribute(int j, char *attr);
+
+int makeExtent(char *extent, char *obj, int attr_index);
+
+bool closeAndTest(char *intent, char *extent, char *attr, int attr_index);
+
+bool isExtentInColumn(char *extent, int attr_index);
+
+void preprocessContext(void);
+
+int groupIdentical(uint64_t *sets, int count, int words, int *members, int *start);
+
+void mapConcept(uint64_t *extent, uint64_t *intent, uint64_t *mapped_extent, uint64_t *mapped_intent);
+
+void packContext(void);
+
+void packRows(void);
+
+size_t crossTableSize(void);
+
+void unpackContext(void);
+
+void buildInitialConceptBits(uint64_t *obj, uint64_t *attr);
+
+void computeConceptFromBits(arena_t *arena, uint64_t *obj, uint64_t *attr, int attr_index);
+
+void openArena(arena_t *arena);
+
+void closeArena(arena_t *arena);
+
+frame_t *frameAt(arena_t *arena, int depth);
+
+long processConceptBits(uint64_t *obj, uint64_t *attr, long parent);
+
+bool checkAttributeBits(int j, uint64_t *attr);
+
+void makeExtentBits(uint64_t *extent, uint64_t *obj, int attr_index);
+
+bool isFrequentBits(uint64_t *extent);
+
+void makeIntentBits(uint64_t *intent, uint64_t *extent);
+
+bool closeAndTestBits(uint64_t *intent, uint64_t *extent, uint64_t *attr, int attr_index);
+
+int closeOrFailingBits(uint64_t *intent, uint64_t *extent, uint64_t *attr, int attr_index);
+
+bool isExtentInColumnBits(uint64_t *extent, int attr_index);
+
+void selectKernels(char *name);
+
+void checkKernels(uint64_t *obj, uint64_t *attr);
+
+void emitDigest(sink_t *sink, uint64_t *extent, uint64_t *intent);
+
+bool scalarSupported(void);
+
+void intersectScalar(uint64_t *result, uint64_t *a, uint64_t *b, int words);
+
+bool subsetScalar(uint64_t *a, uint64_t *b, int words);
+
+long popcountScalar(uint64_t *a, int words);
+
+#if defined(__x86_64__) || defined(__i386__)
+bool avx2Supported(void);
+
+void intersectAvx2(uint64_t *result, uint64_t *a, uint64_t *b, int words);
+
+bool subsetAvx2(uint64_t *a, uint64_t *b, int words);
+
+long popcountAvx2(uint64_t *a, int words);
+
+bool avx512Supported(void);
+
+void intersectAvx512(uint64_t *result, uint64_t *a, uint64_t *b, int words);
+
+bool subsetAvx512(uint64_t *a, uint64_t *b, int words);
+
+long popcountAvx512(uint64_t *a, int words);
+#endif
+
+void packSparse(void);
+
+void computeConceptFromSparse(arena_t *arena, uint64_t *obj, uint64_t *attr);
+
+void makeSparseFrame(frame_t *frame);
+
+void makeExtentSparse(frame_t *child, frame_t *parent, int attr_index);
+
+bool closeAndTestSparse(uint64_t *intent, int *tids, int tid_count, uint64_t *attr, int attr_index);
+
+void computeConceptFromFast(arena_t *arena, uint64_t *obj, uint64_t *attr);
+
+void expandConceptFast(frame_t *frame, int *failing);
+
+void computeConceptFromInClose(arena_t *arena, uint64_t *obj, uint64_t *attr);
+
+void expandConceptInClose(frame_t *frame, int *failing);
+
+int failingAttributeBits(uint64_t *extent, uint64_t *intent, int attr_index);
+
+void planShards(uint64_t *obj, uint64_t *attr);
+
+long countBranch(uint64_t *extent, uint64_t *intent, int attr_index, int levels);
+
+bool ownsRoot(arena_t *arena);
+
+bool ownsBranch(arena_t *arena, int depth, int j);
+
+bool loadCheckpoint(char *file_path);
+
+bool checkpointDue(void);
+
+void saveCheckpoint(arena_t *arena, int depth);
+
+int restoreCheckpoint(arena_t *arena, uint64_t *obj, uint64_t *attr);
+
+uint64_t contextHash(void);
+
+void requestCheckpoint(int signal_number);
+
+void updateConcepts(char *file_path);
+
+void readConceptStream(lattice_t *store, char *file_path, uint32_t *objects);
+
+long *addObject(lattice_t *store, int object, long *table, long *table_size, uint64_t *extents, uint64_t *intents,
+                int *next);
+
+long *mergeConcept(lattice_t *store, uint64_t *extent, uint64_t *intent, long *table, long *table_size);
+
+void insertConcept(lattice_t *store, long *table, long table_size, long id);
+
+long *growTable(lattice_t *store, long *table, long *table_size);
+
+bool verifyUpdate(uint64_t *obj, uint64_t *attr);
+
+void computeImplicationBasis(void);
+
+bool closeUnderImplications(implications_t *basis, uint64_t *set, int limit, uint64_t *prefix);
+
+bool fireImplication(implications_t *basis, long k, uint64_t *set, int limit, uint64_t *prefix, int *pending);
+
+void addImplication(implications_t *basis, uint64_t *premise, uint64_t *conclusion);
+
+void writeImplication(FILE *file, uint64_t *premise, uint64_t *conclusion, long support);
+
+void estimateConcepts(uint64_t *obj, uint64_t *attr);
+
+void printInterval(char *name, double sum, double squares, long samples, char *unit, bool reliable);
+
+void computeConceptFromBatch(uint64_t *obj, uint64_t *attr);
+
+void *batchLoop(void *arg);
+
+void runBatchPass(batch_pass_t pass);
+
+void batchPass(void);
+
+void reserveFrontier(long count);
+
+void computeConceptsParallel(uint64_t *obj, uint64_t *attr);
+
+void *workerLoop(void *arg);
+
+void computeConceptFromParallel(uint64_t *obj, uint64_t *attr, int attr_index, int depth);
+
+void spawnTask(uint64_t *obj, uint64_t *attr, int attr_index, int depth);
+
+void pushTask(deque_t *deque, task_t *task);
+
+task_t *popTask(deque_t *deque);
+
+task_t *stealTask(deque_t *deque);
+
+task_t *findTask(worker_t *self);
+
+void openOutput(void);
+
+void closeOutput(void);
+
+off_t drainOutput(void);
+
+void openSink(sink_t *sink);
+
+void closeSink(sink_t *sink);
+
+void emitConcept(uint64_t *extent, uint64_t *intent);
+
+void emitCount(sink_t *sink, uint64_t *extent, uint64_t *intent);
+
+void emitText(sink_t *sink, uint64_t *extent, uint64_t *intent);
+
+void emitBinary(sink_t *sink, uint64_t *extent, uint64_t *intent);
+
+size_t maxRecordSize(void);
+
+void reserveOutput(sink_t *sink, size_t size);
+
+output_buffer_t *acquireBuffer(void);
+
+void submitBuffer(output_buffer_t *buffer);
+
+void *writerLoop(void *arg);
+
+double elapsedSeconds(struct timespec *from, struct timespec *to);
+
+void openLattice(lattice_t *store);
+
+void closeLattice(lattice_t *store);
+
+long storeConcept(lattice_t *store, uint64_t *extent, uint64_t *intent, long parent);
+
+void buildCovers(lattice_t *store);
+
+long findConcept(lattice_t *store, long *table, long table_size, uint64_t *intent);
+
+uint64_t hashBits(uint64_t *set, int words);
+
+void writeLattice(lattice_t *store, char *file_path);
+
+#ifdef CBO_STATS
+uint64_t readCycles(void);
+
+stats_t *threadStats(void);
+
+void recordCall(stat_kind_t kind, uint64_t cycles);
+
+void recordFailure(void);
+
+void recordConcept(uint64_t *extent);
+
+void dumpStats(void);
+#endif
+
+void usage(char *program);
+
+int main(int argc, char *argv[]) {
+    int opt;
+    while ((opt = getopt(argc, argv, "e:t:d:c:vo:f:S:pr:k:D:L:m:s:C:I:u:VgE:")) != -1) {
+        switch (opt) {
+            case 'e':
+                // select enumeration engine
+                if (strcmp(optarg, "cbo") == 0) {
+                    engine = ENGINE_CBO;
+                } else if (strcmp(optarg, "bits") == 0) {
+                    engine = ENGINE_BITS;
+                } else if (strcmp(optarg, "fcbo") == 0) {
+                    engine = ENGINE_FCBO;
+                } else if (strcmp(optarg, "sparse") == 0) {
+                    engine = ENGINE_SPARSE;
+                } else if (strcmp(optarg, "inclose") == 0) {
+                    engine = ENGINE_INCLOSE;
+                } else if (strcmp(optarg, "batch") == 0) {
+                    engine = ENGINE_BATCH;
+                } else {
+                    usage(argv[0]);
+                }
+                break;
+            case 't':
+                // set worker thread count
+                thread_count = atoi(optarg);
+                if (thread_count < 1) {
+                    usage(argv[0]);
+                }
+                break;
+            case 'd':
+                // set task split depth
+                split_depth = atoi(optarg);
+                if (split_depth < 0) {
+                    usage(argv[0]);
+                }
+                break;
+            case 'c':
+                // set binary context cache location
+                cache_path = optarg;
+                break;
+            case 'v':
+                // print loaded cross table
+                verbose = true;
+                break;
+            case 'o':
+                // select concept output sink
+                if (strcmp(optarg, "count") == 0) {
+                    sink_kind = SINK_COUNT;
+                } else if (strcmp(optarg, "text") == 0) {
+                    sink_kind = SINK_TEXT;
+                } else if (strcmp(optarg, "binary") == 0) {
+                    sink_kind = SINK_BINARY;
+                } else {
+                    usage(argv[0]);
+                }
+                break;
+            case 'f':
+                // set concept output location
+                output_path = optarg;
+                break;
+            case 'S':
+                // set instrumentation JSON location
+                stats_path = optarg;
+                break;
+            case 'p':
+                // clarify context and remove reducible attributes
+                reduce_context = true;
+                break;
+            case 'r':
+                // select attribute order
+                if (strcmp(optarg, "asc") == 0) {
+                    attribute_order = ORDER_ASCENDING;
+                } else if (strcmp(optarg, "desc") == 0) {
+                    attribute_order = ORDER_DESCENDING;
+                } else if (strcmp(optarg, "none") == 0) {
+                    attribute_order = ORDER_NONE;
+                } else {
+                    usage(argv[0]);
+                }
+                break;
+            case 'k':
+                // select bitset kernel variant, or check that all variants agree
+                kernel_name = optarg;
+                break;
+            case 'm':
+                // set minimum support, concepts with fewer objects are not enumerated
+                min_support = atoi(optarg);
+                if (min_support < 0) {
+                    usage(argv[0]);
+                }
+                break;
+            case 's':
+                // set shard of the root branches run by this process, as index/count
+                if (sscanf(optarg, "%d/%d", &shard_index, &shard_count) != 2 || shard_count < 1
+                    || shard_index < 0 || shard_index >= shard_count) {
+                    usage(argv[0]);
+                }
+                break;
+            case 'C':
+                // set checkpoint location, resumed from when present
+                checkpoint_path = optarg;
+                break;
+            case 'I':
+                // set seconds between checkpoints
+                checkpoint_interval = atof(optarg);
+                if (checkpoint_interval <= 0) {
+                    usage(argv[0]);
+                }
+                break;
+            case 'g':
+                // compute the Duquenne-Guigues implication basis instead of the concepts
+                implication_basis = true;
+                break;
+            case 'E':
+                // set seconds of sampling to estimate the run instead of enumerating
+                estimate_budget = atof(optarg);
+                if (estimate_budget <= 0) {
+                    usage(argv[0]);
+                }
+                break;
+            case 'u':
+                // set concept stream of the first objects, the objects after them are added incrementally
+                update_path = optarg;
+                break;
+            case 'V':
+                // compare incrementally updated concepts with a full enumeration
+                verify_update = true;
+                break;
+            case 'L':
+                // set lattice file location, concepts are stored and their covers computed
+                lattice_path = optarg;
+                break;
+            case 'D':
+                // set extent density below which the sparse engine switches to object ids
+                sparse_density = atof(optarg);
+                if (sparse_density < 0 || sparse_density > 1) {
+                    usage(argv[0]);
+                }
+                break;
+            default:
+                usage(argv[0]);
+        }
+    }
+    if (optind >= argc) {
+        usage(argv[0]);
+    }
+#ifndef CBO_STATS
+    if (stats_path != NULL) {
+        fprintf(stderr, "instrumentation (-S) requires building with -DCBO_STATS\n");
+        exit(EXIT_FAILURE);
+    }
+#endif
+    if (thread_count > 1 && engine != ENGINE_BITS && engine != ENGINE_BATCH) {
+        fprintf(stderr, "parallel mode (-t) requires the bits or batch engine (-e bits, batch)\n");
+        exit(EXIT_FAILURE);
+    }
+    if (lattice_path != NULL && (engine == ENGINE_CBO || engine == ENGINE_BATCH || thread_count > 1)) {
+        fprintf(stderr, "lattice store (-L) requires a serial bitset engine (-e bits, fcbo, sparse or inclose)\n");
+        exit(EXIT_FAILURE);
+    }
+    if (min_support > 0 && reduce_context) {
+        fprintf(stderr, "minimum support (-m) counts loaded objects, it cannot be combined with -p\n");
+        exit(EXIT_FAILURE);
+    }
+    if (shard_count > 1 && (engine == ENGINE_CBO || lattice_path != NULL)) {
+        fprintf(stderr, "sharding (-s) requires a bitset engine and no lattice store (-L)\n");
+        exit(EXIT_FAILURE);
+    }
+    bool check_kernels = strcmp(kernel_name, "check") == 0;
+    bool update_verified = true;
+    if (checkpoint_path != NULL && (engine != ENGINE_BITS || thread_count > 1 || lattice_path != NULL
+                                    || check_kernels)) {
+        fprintf(stderr, "checkpoints (-C) require the serial bits engine (-e bits) and no lattice store (-L)\n");
+        exit(EXIT_FAILURE);
+    }
+    if (update_path != NULL && (reduce_context || attribute_order != ORDER_NONE || min_support > 0 || shard_count > 1
+                                || lattice_path != NULL || checkpoint_path != NULL || thread_count > 1
+                                || check_kernels)) {
+        fprintf(stderr, "incremental update (-u) cannot be combined with -p, -r, -m, -s, -L, -C, -t or -k check\n");
+        exit(EXIT_FAILURE);
+    }
+    if (implication_basis && (reduce_context || min_support > 0 || shard_count > 1 || lattice_path != NULL
+                              || checkpoint_path != NULL || update_path != NULL || thread_count > 1 || check_kernels
+                              || sink_kind == SINK_BINARY)) {
+        fprintf(stderr, "implication basis (-g) is written as text, it cannot be combined with -p, -m, -s, -L, -C, -u,"
+                        " -t, -k check or -o binary\n");
+        exit(EXIT_FAILURE);
+    }
+    if (implication_basis) {
+        engine = ENGINE_BITS; // closures on bitsets
+    }
+    if (estimate_budget > 0 && ((engine != ENGINE_CBO && engine != ENGINE_BITS) || shard_count > 1
+                                || lattice_path != NULL || checkpoint_path != NULL || update_path != NULL
+                                || implication_basis || thread_count > 1 || check_kernels)) {
+        fprintf(stderr, "estimate (-E) samples the tree of the serial bits engine, it cannot be combined with other"
+                        " engines, -s, -L, -C, -u, -g, -t or -k check\n");
+        exit(EXIT_FAILURE);
+    }
+    if (estimate_budget > 0) {
+        engine = ENGINE_BITS; // paths of the bits engine
+    }
+    if (verify_update && update_path == NULL) {
+        fprintf(stderr, "update check (-V) requires a stored concept stream (-u)\n");
+        exit(EXIT_FAILURE);
+    }
+    if (update_path != NULL && engine == ENGINE_CBO) {
+        engine = ENGINE_BITS; // the update and its check run on bitsets
+    }
+    if (checkpoint_path != NULL && sink_kind != SINK_COUNT && output_path == NULL) {
+        fprintf(stderr, "checkpoints (-C) record the concept output offset, they require an output file (-f)\n");
+        exit(EXIT_FAILURE);
+    }
+    if (check_kernels) {
+        if (engine == ENGINE_CBO) {
+            engine = ENGINE_BITS; // kernels are used by the bitset engines only
+        }
+        thread_count = 1;
+        sink_kind = SINK_COUNT;
+        lattice_path = NULL; // nothing stored while checking
+        selectKernels("scalar"); // until the check switches variants
+    } else {
+        selectKernels(kernel_name);
+    }
+
+    loadContext(argv[optind]); // read data from file path
+    if (reduce_context || attribute_order != ORDER_NONE) {
+        preprocessContext(); // clarify, reduce and reorder before enumeration
+    }
+    if (engine != ENGINE_CBO) {
+        packContext(); // pack cross table into column and row bitsets
+        if (engine == ENGINE_SPARSE) {
+            packSparse(); // object id lists per attribute, attribute id lists per object
+        }
+    }
+    if (checkpoint_path != NULL) {
+        checkpoint_context_hash = contextHash();
+        resuming = loadCheckpoint(checkpoint_path); // continue an interrupted run
+    }
+    openOutput(); // start concept output
+    openSink(&main_sink);
+    if (resuming) {
+        main_sink.concept_count = (long) resume_header.concept_count; // already output
+        printf("resuming : %ld concepts output, depth %u\n\n", main_sink.concept_count, resume_header.frames - 1);
+    }
+
+    if (engine != ENGINE_CBO) {
+        uint64_t *ini_obj = (uint64_t *) malloc(object_words * sizeof(uint64_t)); // initial concept object set
+        uint64_t *ini_attr = (uint64_t *) malloc(attribute_words * sizeof(uint64_t)); // initial concept attribute set
+        buildInitialConceptBits(ini_obj, ini_attr); // make object and attribute sets
+
+        openArena(&main_arena);
+        if (shard_count > 1) {
+            planShards(ini_obj, ini_attr); // same branch split in every shard
+            main_arena.sharded = true;
+        }
+        if (lattice_path != NULL) {
+            openLattice(&lattice);
+        }
+        if (check_kernels) {
+            checkKernels(ini_obj, ini_attr); // enumerate once per kernel variant and exit
+        }
+        if (estimate_budget > 0) {
+            estimateConcepts(ini_obj, ini_attr); // sample tree paths, report and exit
+        }
+        start = clock(); // start timing
+        clock_gettime(CLOCK_MONOTONIC, &wall_start);
+        if (checkpoint_path != NULL) {
+            checkpoint_time = wall_start;
+            signal(SIGINT, requestCheckpoint); // checkpoint and stop instead of losing the run
+            signal(SIGTERM, requestCheckpoint);
+        }
+        if (implication_basis) {
+            computeImplicationBasis(); // pseudo-intents by NextClosure
+        } else if (update_path != NULL) {
+            updateConcepts(update_path); // add objects appended since the stored concepts
+        } else if (!isFrequentBits(ini_obj)) {
+            // no concept reaches the minimum support
+        } else if (engine == ENGINE_FCBO) {
+            computeConceptFromFast(&main_arena, ini_obj, ini_attr); // invoke Fast Close-by-One
+        } else if (engine == ENGINE_SPARSE) {
+            computeConceptFromSparse(&main_arena, ini_obj, ini_attr); // invoke Close-by-One on object id lists
+        } else if (engine == ENGINE_INCLOSE) {
+            computeConceptFromInClose(&main_arena, ini_obj, ini_attr); // invoke In-Close
+        } else if (engine == ENGINE_BATCH) {
+            computeConceptFromBatch(ini_obj, ini_attr); // invoke batched Close-by-One on thread_count threads
+        } else if (thread_count > 1) {
+            computeConceptsParallel(ini_obj, ini_attr); // invoke parallel Close-by-One on bitsets
+        } else {
+            computeConceptFromBits(&main_arena, ini_obj, ini_attr, 0); // invoke Close-by-One on bitsets
+        }
+        clock_gettime(CLOCK_MONOTONIC, &wall_end);
+        end = clock(); // stop timing
+        if (verify_update) {
+            update_verified = verifyUpdate(ini_obj, ini_attr); // full enumeration of the grown context
+        }
+        closeArena(&main_arena);
+        if (lattice_path != NULL) {
+            buildCovers(&lattice); // covers from the stored concepts
+            writeLattice(&lattice, lattice_path);
+            closeLattice(&lattice);
+        }
+
+        free(ini_obj);
+        free(ini_attr);
+        free(branch_shard);
+        free(bit_columns);
+        free(bit_rows);
+        free(row_start);
+        free(row_attributes);
+    } else {
+        if (cross_table == NULL) {
+            unpackContext(); // loaded packed, expand to '0' / '1' cross table
+        }
+        char *ini_obj = (char *) malloc(data_size * sizeof(char)); // initial concept object list
+        char *ini_attr = (char *) malloc(attribute_size * sizeof(char)); // initial concept attribute list
+        buildInitialConcept(ini_obj, ini_attr); // make object and attribute list
+
+        start = clock(); // start timing
+        clock_gettime(CLOCK_MONOTONIC, &wall_start);
+        if (data_size >= min_support) {
+            computeConceptFrom(ini_obj, ini_attr, 0); // invoke Close-by-One
+        }
+        clock_gettime(CLOCK_MONOTONIC, &wall_end);
+        end = clock(); // stop timing
+
+        free(ini_obj);
+        free(ini_attr);
+        free(bit_rows);
+    }
+
+    closeSink(&main_sink);
+    concept_count += main_sink.concept_count;
+    closeOutput(); // drain buffered concepts
+    if (interrupted) {
+        fprintf(stderr, "interrupted after %ld concepts, resume with -C %s\n", concept_count, checkpoint_path);
+        exit(EXIT_FAILURE);
+    }
+    if (checkpoint_path != NULL && unlink(checkpoint_path) != 0 && errno != ENOENT) {
+        int err_num = errno;
+        fprintf(stderr, "Error removing file: %s: %s\n", checkpoint_path, strerror(err_num));
+    }
+
+    printf("\nTotal Concepts : %ld\n\n", concept_count);
+    printf("execution time : %f seconds\n\n", elapsedSeconds(&wall_start, &wall_end));
+    printf("cpu time : %f seconds\n\n", ((double) (end - start) / CLOCKS_PER_SEC));
+#ifdef CBO_STATS
+    dumpStats();
+#endif
+
+    // Free Memory
+    free(cross_table);
+
+    return update_verified ? 0 : EXIT_FAILURE;
+}
+
+// seconds between two monotonic clock readings
+double elapsedSeconds(struct timespec *from, struct timespec *to) {
+    return (double) (to->tv_sec - from->tv_sec) + (double) (to->tv_nsec - from->tv_nsec) / 1e9;
+}
+
+// print command line usage and exit
+void usage(char *program) {
+    fprintf(stderr, "usage: %s [-e cbo|bits|fcbo|sparse|inclose|batch] [-t threads] [-d split_depth] [-c cache] [-v]\n"
+                    "          [-o count|text|binary] [-f output] [-S stats.json]\n"
+                    "          [-p] [-r asc|desc|none] [-k auto|scalar|avx2|avx512|check]\n"
+                    "          [-D density] [-L lattice] [-m min_support] [-s index/count]\n"
+                    "          [-C checkpoint] [-I seconds] [-u stored.cbos [-V]] [-g] [-E seconds] <file.cxt>\n",
+            program);
+    fprintf(stderr, "  -e  enumeration engine (default: cbo)\n");
+    fprintf(stderr, "  -t  worker threads, parallel mode when above 1, batch engine team size (default: 1)\n");
+    fprintf(stderr, "  -d  depth up to which branches are spawned as tasks (default: 2)\n");
+    fprintf(stderr, "  -c  binary context cache, written from the .cxt and loaded while newer than it\n");
+    fprintf(stderr, "  -v  print loaded cross table\n");
+    fprintf(stderr, "  -o  concept output sink (default: text)\n");
+    fprintf(stderr, "  -f  concept output file (default: stdout)\n");
+    fprintf(stderr, "  -S  instrumentation JSON file, builds with -DCBO_STATS only\n");
+    fprintf(stderr, "  -p  merge identical objects and attributes, remove reducible attributes\n");
+    fprintf(stderr, "  -r  order attributes by support before enumeration (default: none)\n");
+    fprintf(stderr, "  -k  bitset kernel variant, check compares the concepts of all supported (default: auto)\n");
+    fprintf(stderr, "  -D  sparse engine extent density below which object id lists are used (default: auto)\n");
+    fprintf(stderr, "  -m  minimum extent size, smaller concepts are cut during enumeration (default: 0)\n");
+    fprintf(stderr, "  -s  run shard index (from 0) of count, root branches split by estimated cost\n");
+    fprintf(stderr, "  -C  checkpoint file of the serial bits engine, resumed from when present\n");
+    fprintf(stderr, "  -I  seconds between checkpoints (default: 5)\n");
+    fprintf(stderr, "  -u  binary concept stream of the first objects, the remaining objects are added to it\n");
+    fprintf(stderr, "  -V  compare the updated concepts with a full enumeration\n");
+    fprintf(stderr, "  -g  Duquenne-Guigues implication basis, \"premise -> conclusion ; support\" per line\n");
+    fprintf(stderr, "  -E  seconds of random tree paths sampled to estimate concepts, depth and runtime\n");
+    fprintf(stderr, "  -L  lattice file, concepts with Close-by-One parents and cover relation (serial bitset engines)\n");
+    exit(EXIT_FAILURE);
+}
+
+// load data set from given location, binary context, fresh binary cache or .cxt file
+void loadContext(char *file_path) {
+    struct stat source;
+    struct stat cached;
+    if (isBinaryContext(file_path)) {
+        loadBinaryContext(file_path);
+    } else if (cache_path != NULL && stat(file_path, &source) == 0 && stat(cache_path, &cached) == 0
+               && cached.st_mtime >= source.st_mtime && isBinaryContext(cache_path)) {
+        loadBinaryContext(cache_path); // cache written after the .cxt last changed
+    } else {
+        loadData(file_path);
+        if (cache_path != NULL) {
+            packRows();
+            writeBinaryContext(cache_path);
+        }
+    }
+    output_data_size = data_size;
+    output_attribute_size = attribute_size;
+    if (verbose) {
+        printContext();
+    }
+}
+
+// load .cxt data set file from given location, parsed in place from a read only mapping, copied to libcbo.c
+void loadData(char *file_path) {
+    int fd;
+    struct stat info;
+    if ((fd = open(file_path, O_RDONLY)) == -1 || fstat(fd, &info) == -1) {
+        int err_num = errno;
+        fprintf(stderr, "Error opening file: %s: %s\n", file_path, strerror(err_num));
+        exit(EXIT_FAILURE);
+    }
+    if (info.st_size == 0) {
+        fprintf(stderr, "Error reading file: %s: empty file\n", file_path);
+        exit(EXIT_FAILURE);
+    }
+    char *data = (char *) mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data == MAP_FAILED) {
+        int err_num = errno;
+        fprintf(stderr, "Error mapping file: %s: %s\n", file_path, strerror(err_num));
+        exit(EXIT_FAILURE);
+    }
+    close(fd);
+    madvise(data, info.st_size, MADV_SEQUENTIAL);
+
+    char *cursor = data;
+    char *end = data + info.st_size;
+    char *line;
+    size_t len;
+    int i, x;
+    /**
+     * Burmeister format, blank lines are skipped
+     * B, object count, attribute count, object names, attribute names, one row of 'X' / '.' per object
+     */
+    if (!nextLine(&cursor, end, &line, &len) || line[0] != 'B') {
+        fprintf(stderr, "Error reading file: %s: missing Burmeister header\n", file_path);
+        exit(EXIT_FAILURE);
+    }
+    if (!nextLine(&cursor, end, &line, &len) || (data_size = atoi(line)) <= 0
+        || !nextLine(&cursor, end, &line, &len) || (attribute_size = atoi(line)) <= 0) {
+        fprintf(stderr, "Error reading file: %s: invalid context size\n", file_path);
+        exit(EXIT_FAILURE);
+    }
+    object_words = WORDS_FOR(data_size);
+    attribute_words = WORDS_FOR(attribute_size);
+    // object and attribute names are not used
+    for (i = 0; i < data_size + attribute_size; i++) {
+        if (!nextLine(&cursor, end, &line, &len)) {
+            fprintf(stderr, "Error reading file: %s: missing names\n", file_path);
+            exit(EXIT_FAILURE);
+        }
+    }
+    cross_table = (char *) malloc(crossTableSize()); // allocate cross table
+    if (cross_table == NULL) {
+        fprintf(stderr, "Error allocating cross table\n");
+        exit(EXIT_FAILURE);
+    }
+    // read cross table
+    for (i = 0; i < data_size; i++) {
+        if (!nextLine(&cursor, end, &line, &len)) {
+            fprintf(stderr, "Error reading file: %s: found %d of %d rows\n", file_path, i, data_size);
+            exit(EXIT_FAILURE);
+        }
+        char *row = &cross_table[(size_t) i * attribute_size];
+        for (x = 0; x < attribute_size; x++) {
+            // assign one when 'X', zero when '.' or row ends early
+            row[x] = (x < (int) len && (line[x] == 'X' || line[x] == 'x')) ? '1' : '0';
+        }
+    }
+    munmap(data, info.st_size);
+}
+
+// move cursor to the next non blank line, line excludes the line break
+bool nextLine(char **cursor, char *end, char **line, size_t *len) {
+    while (*cursor < end) {
+        char *start = *cursor;
+        char *stop = memchr(start, '\n', end - start);
+        if (stop == NULL) {
+            stop = end;
+        }
+        *cursor = (stop < end) ? stop + 1 : end;
+        size_t length = stop - start;
+        if (length > 0 && start[length - 1] == '\r') {
+            length--;
+        }
+        if (length > 0) {
+            *line = start;
+            *len = length;
+            return true;
+        }
+    }
+    return false;
+}
+
+// print cross table as '0' / '1' rows
+void printContext(void) {
+    int i, a;
+    printf("\n~~~ Dataset Cross Table ~~~\n\n");
+    for (i = 0; i < data_size; i++) {
+        for (a = 0; a < attribute_size; a++) {
+            bool present = (cross_table != NULL)
+                           ? cross_table[((size_t) i * attribute_size) + a] == '1'
+                           : (bit_rows[(size_t) i * attribute_words + BIT_WORD(a)] & BIT_MASK(a)) != 0;
+            putchar(present ? '1' : '0');
+        }
+        putchar('\n');
+    }
+    printf("\n");
+}
+
+// check file starts with the binary context magic
+bool isBinaryContext(char *file_path) {
+    char magic[sizeof(BINARY_CONTEXT_MAGIC) - 1];
+    FILE *file = fopen(file_path, "rb");
+    if (file == NULL) {
+        return false;
+    }
+    bool status = fread(magic, 1, sizeof(magic), file) == sizeof(magic)
+                  && memcmp(magic, BINARY_CONTEXT_MAGIC, sizeof(magic)) == 0;
+    fclose(file);
+    return status;
+}
+
+// load binary context, header followed by packed object rows read in one go, copied to libcbo.c
+void loadBinaryContext(char *file_path) {
+    int fd;
+    struct stat info;
+    binary_context_header_t header;
+    if ((fd = open(file_path, O_RDONLY)) == -1 || fstat(fd, &info) == -1) {
+        int err_num = errno;
+        fprintf(stderr, "Error opening file: %s: %s\n", file_path, strerror(err_num));
+        exit(EXIT_FAILURE);
+    }
+    if (read(fd, &header, sizeof(header)) != (ssize_t) sizeof(header)
+        || memcmp(header.magic, BINARY_CONTEXT_MAGIC, sizeof(header.magic)) != 0
+        || header.version != BINARY_CONTEXT_VERSION || header.objects == 0 || header.attributes == 0
+        || header.objects > INT32_MAX || header.attributes > INT32_MAX) {
+        fprintf(stderr, "Error reading file: %s: invalid binary context header\n", file_path);
+        exit(EXIT_FAILURE);
+    }
+    data_size = (int) header.objects;
+    attribute_size = (int) header.attributes;
+    object_words = WORDS_FOR(data_size);
+    attribute_words = WORDS_FOR(attribute_size);
+    size_t rows_size = (size_t) data_size * attribute_words * sizeof(uint64_t);
+    if ((size_t) info.st_size != sizeof(header) + rows_size) {
+        fprintf(stderr, "Error reading file: %s: size does not match header\n", file_path);
+        exit(EXIT_FAILURE);
+    }
+    bit_rows = (uint64_t *) malloc(rows_size);
+    if (bit_rows == NULL) {
+        fprintf(stderr, "Error allocating packed cross table\n");
+        exit(EXIT_FAILURE);
+    }
+    size_t done = 0;
+    while (done < rows_size) {
+        ssize_t got = read(fd, (char *) bit_rows + done, rows_size - done);
+        if (got <= 0) {
+            fprintf(stderr, "Error reading file: %s: truncated rows\n", file_path);
+            exit(EXIT_FAILURE);
+        }
+        done += got;
+    }
+    close(fd);
+    // bits past the last attribute would be transposed into columns that do not exist
+    long row = findPaddingRow(bit_rows, data_size, attribute_size);
+    if (row >= 0) {
+        fprintf(stderr, "Error reading file: %s: row %ld has bits past attribute %d\n", file_path, row,
+                attribute_size - 1);
+        exit(EXIT_FAILURE);
+    }
+}
+
+// first packed row with a bit set at or above attributes in its last word, -1 when every row is clean
+long findPaddingRow(uint64_t *rows, int objects, int attributes) {
+    int words = WORDS_FOR(attributes);
+    long i;
+    if (attributes % WORD_BITS == 0) {
+        return -1; // last word holds attributes only
+    }
+    uint64_t padding = ~(BIT_MASK(attributes) - 1); // bits of the last word past the last attribute
+    for (i = 0; i < objects; i++) {
+        if ((rows[i * words + words - 1] & padding) != 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// write packed object rows as binary context
+void writeBinaryContext(char *file_path) {
+    binary_context_header_t header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, BINARY_CONTEXT_MAGIC, sizeof(header.magic));
+    header.version = BINARY_CONTEXT_VERSION;
+    header.objects = data_size;
+    header.attributes = attribute_size;
+    // write next to the target and rename, readers never see a partial cache
+    char temp_path[strlen(file_path) + 5];
+    snprintf(temp_path, sizeof(temp_path), "%s.tmp", file_path);
+    FILE *file = fopen(temp_path, "wb");
+    if (file == NULL) {
+        int err_num = errno;
+        fprintf(stderr, "Error writing file: %s: %s\n", temp_path, strerror(err_num));
+        return; // cache is optional, keep going
+    }
+    bool status = fwrite(&header, sizeof(header), 1, file) == 1
+                  && fwrite(bit_rows, sizeof(uint64_t), (size_t) data_size * attribute_words, file)
+                     == (size_t) data_size * attribute_words;
+    if (fclose(file) != 0 || !status || rename(temp_path, file_path) != 0) {
+        fprintf(stderr, "Error writing file: %s\n", file_path);
+        remove(temp_path);
+    }
+}
+
+// build up initial concept
+// out: objects, attributes
+void buildInitialConcept(char *obj, char *attr) {
+    int i;
+    int a;
+    /**
+     * assign objects
+     * pass all objects into list, according to the theorem, (X)
+     */
+    for (i = 0; i < data_size; i++) {
+        obj[i] = '1';
+    }
+
+    /**
+     * assign attributes
+     * set common attribute list for all objects on cross table (X up)
+     */
+    // go through attributes
+    for (a = 0; a < attribute_size; a++) {
+        bool status = true;
+        // go through objects
+        for (i = 0; i < data_size; i++) {
+            if (cross_table[((size_t) i * attribute_size) + a] == '0') {
+                status = false;
+                break;
+            }
+        }
+        if (status) {
+            // attribute available for all objects, assign 1
+            attr[a] = '1';
+        } else {
+            attr[a] = '0';
+        }
+    }
+}
+
+/**
+ * Close-by-One Algorithm
+ *
+ * input :  1. object list
+ *          2. attribute list
+ *          3. current attribute index
+ */
+void computeConceptFrom(char *obj, char *attr, int attr_index) {
+    // 1. Process Concept
+    processConcept(obj, attr);
+    // 2. go through attribute list
+    int j;
+    for (j = attr_index; j < attribute_size; j++) {
+        // 3. check current attribute exist or not
+        if (!checkAttribute(j, attr)) {
+            STATS_PUSH();
+            // 4. make extent, the branch is cut below minimum support
+            char extent[data_size];
+            if (makeExtent(extent, obj, j) >= min_support) {
+                // 5. make intent fused with canonicity test
+                char intent[attribute_size];
+                if (closeAndTest(intent, extent, attr, j)) {
+                    // 6. call computeConceptFrom
+                    computeConceptFrom(extent, intent, (j + 1));
+                }
+            }
+            STATS_POP();
+        }
+    }
+}
+
+// store concept
+void processConcept(char *obj, char *attr) {
+    int i;
+    uint64_t extent[object_words];
+    uint64_t intent[attribute_words];
+    memset(extent, 0, sizeof(extent));
+    memset(intent, 0, sizeof(intent));
+    for (i = 0; i < data_size; i++) {
+        if (obj[i] == '1') {
+            extent[BIT_WORD(i)] |= BIT_MASK(i);
+        }
+    }
+    for (i = 0; i < attribute_size; i++) {
+        if (attr[i] == '1') {
+            intent[BIT_WORD(i)] |= BIT_MASK(i);
+        }
+    }
+    emitConcept(extent, intent);
+}
+
+// check attribute contains on attribute list or not
+bool checkAttribute(int j, char *attr) {
+    bool status = true;
+    if (attr[j] == '0') {
+        status = false;
+    }
+    return status;
+}
+
+// make extent, returns its object count
+int makeExtent(char *extent, char *obj, int attr_index) {
+    int i;
+    int count = 0;
+    STATS_START(timer);
+//    printf("extent (attr : %d): ", attr_index);
+    // go through cross table
+    for (i = 0; i < data_size; i++) {
+        extent[i] = '0'; // set default value
+        if (cross_table[((size_t) i * attribute_size) + attr_index] == '1' && obj[i] != '0') {
+            extent[i] = '1'; // set object index to extent list
+            count++;
+        }
+//        printf("%c ", extent[i]);
+    }
+//    printf("\n");
+    STATS_STOP(timer, STAT_EXTENT);
+    return count;
+}
+
+/**
+ * make intent fused with canonicity test
+ *
+ * Attributes of attr hold any extent taken from attr's objects, so only the others are tested. Those below
+ * attr_index are tested first and the first one holding the extent rejects the candidate, the intent is finished
+ * from attr_index on only when none is found.
+ *
+ * input :  1. intent to fill, complete only when true is returned
+ *          2. extent of the candidate
+ *          3. attribute list of the parent concept
+ *          4. current attribute index
+ */
+bool closeAndTest(char *intent, char *extent, char *attr, int attr_index) {
+    int a;
+    STATS_START(timer);
+    // 1. attributes below attr_index, rejected on the first new one
+    for (a = 0; a < attr_index; a++) {
+        if (attr[a] == '0' && isExtentInColumn(extent, a)) {
+            STATS_STOP(timer, STAT_FUSED);
+            STATS_FAILURE();
+            return false;
+        }
+    }
+    // 2. canonical, same as attr below attr_index, finish attributes from attr_index on
+    memcpy(intent, attr, attr_index);
+    for (a = attr_index; a < attribute_size; a++) {
+        intent[a] = (attr[a] == '1' || isExtentInColumn(extent, a)) ? '1' : '0';
+    }
+    STATS_STOP(timer, STAT_FUSED);
+    return true;
+}
+
+// check every object of extent has attribute attr_index, true for the empty extent
+bool isExtentInColumn(char *extent, int attr_index) {
+    int i;
+    for (i = 0; i < data_size; i++) {
+        if (extent[i] != '0' && cross_table[((size_t) i * attribute_size) + attr_index] != '1') {
+            return false;
+        }
+    }
+    return true;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+// Context preprocessing
+//
+// Objects with identical rows and attributes with identical columns are merged (clarification). An attribute whose
+// column is the intersection of the columns strictly containing it is reducible, it belongs to an intent exactly
+// when all irreducible attributes containing it do, so it is removed. The concept lattice keeps its shape. The
+// remaining attributes may be reordered by support. Emitted concepts are mapped back to the loaded context.
+// ---------------------------------------------------------------------------------------------------------------------
+
+// replace loaded context with its clarified, reduced and reordered packed rows
+void preprocessContext(void) {
+    int i, a, b, w;
+    if (bit_rows == NULL) {
+        packRows();
+    }
+
+    // 1. merge objects with identical rows
+    object_class_members = (int *) malloc(data_size * sizeof(int));
+    object_class_start = (int *) malloc((data_size + 1) * sizeof(int));
+    int objects = reduce_context ? groupIdentical(bit_rows, data_size, attribute_words, object_class_members,
+                                                  object_class_start) : data_size;
+    if (!reduce_context) {
+        for (i = 0; i <= data_size; i++) {
+            object_class_start[i] = i;
+            if (i < data_size) {
+                object_class_members[i] = i;
+            }
+        }
+    }
+    int words = WORDS_FOR(objects);
+
+    // 2. columns over merged objects, support counts loaded objects
+    uint64_t *columns = (uint64_t *) calloc((size_t) attribute_size * words, sizeof(uint64_t));
+    long *support = (long *) calloc(attribute_size, sizeof(long));
+    for (i = 0; i < objects; i++) {
+        uint64_t *row = &bit_rows[(size_t) object_class_members[object_class_start[i]] * attribute_words];
+        for (a = 0; a < attribute_size; a++) {
+            if (row[BIT_WORD(a)] & BIT_MASK(a)) {
+                columns[(size_t) a * words + BIT_WORD(i)] |= BIT_MASK(i);
+                support[a] += object_class_start[i + 1] - object_class_start[i];
+            }
+        }
+    }
+
+    // 3. merge attributes with identical columns
+    attribute_class_members = (int *) malloc(attribute_size * sizeof(int));
+    attribute_class_start = (int *) malloc((attribute_size + 1) * sizeof(int));
+    if (reduce_context) {
+        attribute_classes = groupIdentical(columns, attribute_size, words, attribute_class_members,
+                                           attribute_class_start);
+    } else {
+        attribute_classes = attribute_size;
+        for (a = 0; a <= attribute_size; a++) {
+            attribute_class_start[a] = a;
+            if (a < attribute_size) {
+                attribute_class_members[a] = a;
+            }
+        }
+    }
+    uint64_t *class_columns = (uint64_t *) malloc((size_t) attribute_classes * words * sizeof(uint64_t));
+    long *class_support = (long *) malloc(attribute_classes * sizeof(long));
+    for (a = 0; a < attribute_classes; a++) {
+        int first = attribute_class_members[attribute_class_start[a]];
+        memcpy(&class_columns[(size_t) a * words], &columns[(size_t) first * words], words * sizeof(uint64_t));
+        class_support[a] = support[first];
+    }
+    free(columns);
+    free(support);
+
+    // 4. find reducible attributes, column equals the intersection of the columns strictly containing it
+    bool *reducible = (bool *) calloc(attribute_classes, sizeof(bool));
+    uint64_t *meet = (uint64_t *) malloc(words * sizeof(uint64_t));
+    int kept = attribute_classes;
+    for (a = 0; reduce_context && a < attribute_classes; a++) {
+        uint64_t *column = &class_columns[(size_t) a * words];
+        for (w = 0; w < words; w++) {
+            meet[w] = ~0ULL;
+        }
+        if (objects % WORD_BITS != 0) {
+            meet[words - 1] = BIT_MASK(objects) - 1;
+        }
+        for (b = 0; b < attribute_classes; b++) {
+            uint64_t *other = &class_columns[(size_t) b * words];
+            bool superset = (b != a);
+            for (w = 0; w < words && superset; w++) {
+                superset = (column[w] & ~other[w]) == 0;
+            }
+            if (superset) {
+                // clarified, so containing means strictly containing
+                for (w = 0; w < words; w++) {
+                    meet[w] &= other[w];
+                }
+            }
+        }
+        if (memcmp(meet, column, words * sizeof(uint64_t)) == 0 && kept > 1) {
+            reducible[a] = true;
+            kept--;
+        }
+    }
+    free(meet);
+
+    // 5. order irreducible attributes, ties keep file order
+    int *order = (int *) malloc(kept * sizeof(int));
+    int count = 0;
+    for (a = 0; a < attribute_classes; a++) {
+        if (!reducible[a]) {
+            order[count++] = a;
+        }
+    }
+    if (attribute_order != ORDER_NONE) {
+        // insertion sort, stable
+        for (i = 1; i < kept; i++) {
+            int current = order[i];
+            int j = i - 1;
+            while (j >= 0 && (attribute_order == ORDER_ASCENDING ? class_support[order[j]] > class_support[current]
+                                                                 : class_support[order[j]] < class_support[current])) {
+                order[j + 1] = order[j];
+                j--;
+            }
+            order[j + 1] = current;
+        }
+    }
+    attribute_class_reduced = (int *) malloc(attribute_classes * sizeof(int));
+    for (a = 0; a < attribute_classes; a++) {
+        attribute_class_reduced[a] = -1;
+    }
+    for (i = 0; i < kept; i++) {
+        attribute_class_reduced[order[i]] = i;
+    }
+
+    // 6. reducible attributes are implied by the irreducible attributes containing them
+    int reduced_words = WORDS_FOR(kept);
+    attribute_class_required = (uint64_t *) calloc((size_t) attribute_classes * reduced_words, sizeof(uint64_t));
+    for (a = 0; a < attribute_classes; a++) {
+        if (!reducible[a]) {
+            continue;
+        }
+        uint64_t *column = &class_columns[(size_t) a * words];
+        for (b = 0; b < attribute_classes; b++) {
+            uint64_t *other = &class_columns[(size_t) b * words];
+            bool superset = (b != a && !reducible[b]);
+            for (w = 0; w < words && superset; w++) {
+                superset = (column[w] & ~other[w]) == 0;
+            }
+            if (superset) {
+                int r = attribute_class_reduced[b];
+                attribute_class_required[(size_t) a * reduced_words + BIT_WORD(r)] |= BIT_MASK(r);
+            }
+        }
+    }
+
+    // 7. rows of the reduced context
+    uint64_t *rows = (uint64_t *) calloc((size_t) objects * reduced_words, sizeof(uint64_t));
+    for (i = 0; i < objects; i++) {
+        for (b = 0; b < kept; b++) {
+            if (class_columns[(size_t) order[b] * words + BIT_WORD(i)] & BIT_MASK(i)) {
+                rows[(size_t) i * reduced_words + BIT_WORD(b)] |= BIT_MASK(b);
+            }
+        }
+    }
+    if (verbose) {
+        printf("preprocessed context : %d x %d -> %d x %d (%d attributes merged, %d reducible)\n\n", data_size,
+               attribute_size, objects, kept, attribute_size - attribute_classes, attribute_classes - kept);
+    }
+    free(bit_rows);
+    free(cross_table);
+    free(class_columns);
+    free(class_support);
+    free(reducible);
+    free(order);
+    cross_table = NULL; // unpacked again for the char engine
+    bit_rows = rows;
+    data_size = objects;
+    attribute_size = kept;
+    object_words = words;
+    attribute_words = reduced_words;
+    preprocessed = true;
+}
+
+// group identical bitsets, returns group count, members of group g are members[start[g]] .. members[start[g + 1] - 1]
+int groupIdentical(uint64_t *sets, int count, int words, int *members, int *start) {
+    int i, j;
+    int groups = 0;
+    int *group_of = (int *) malloc(count * sizeof(int));
+    int *group_size = (int *) calloc(count + 1, sizeof(int));
+    int *group_first = (int *) malloc(count * sizeof(int));
+    // open hash table on set contents, groups numbered by their first member
+    int buckets = 1;
+    while (buckets < 2 * count) {
+        buckets <<= 1;
+    }
+    int *table = (int *) malloc(buckets * sizeof(int));
+    for (i = 0; i < buckets; i++) {
+        table[i] = -1;
+    }
+    for (i = 0; i < count; i++) {
+        uint64_t *set = &sets[(size_t) i * words];
+        uint64_t hash = 1469598103934665603ULL;
+        for (j = 0; j < words; j++) {
+            hash = (hash ^ set[j]) * 1099511628211ULL;
+            hash ^= hash >> 29;
+        }
+        int slot = (int) (hash & (buckets - 1));
+        while (table[slot] != -1
+               && memcmp(&sets[(size_t) group_first[table[slot]] * words], set, words * sizeof(uint64_t)) != 0) {
+            slot = (slot + 1) & (buckets - 1);
+        }
+        if (table[slot] == -1) {
+            table[slot] = groups;
+            group_first[groups++] = i;
+        }
+        group_of[i] = table[slot];
+        group_size[table[slot]]++;
+    }
+    // counting sort of members by group
+    start[0] = 0;
+    for (i = 0; i < groups; i++) {
+        start[i + 1] = start[i] + group_size[i];
+        group_size[i] = start[i];
+    }
+    for (i = 0; i < count; i++) {
+        members[group_size[group_of[i]]++] = i;
+    }
+    free(table);
+    free(group_first);
+    free(group_size);
+    free(group_of);
+    return groups;
+}
+
+// map concept of the preprocessed context back to objects and attributes of the loaded context
+void mapConcept(uint64_t *extent, uint64_t *intent, uint64_t *mapped_extent, uint64_t *mapped_intent) {
+    int w, m, a;
+    memset(mapped_extent, 0, WORDS_FOR(output_data_size) * sizeof(uint64_t));
+    memset(mapped_intent, 0, WORDS_FOR(output_attribute_size) * sizeof(uint64_t));
+    // merged objects
+    for (w = 0; w < object_words; w++) {
+        uint64_t bits = extent[w];
+        while (bits != 0) {
+            int r = w * WORD_BITS + __builtin_ctzll(bits);
+            for (m = object_class_start[r]; m < object_class_start[r + 1]; m++) {
+                int o = object_class_members[m];
+                mapped_extent[BIT_WORD(o)] |= BIT_MASK(o);
+            }
+            bits &= bits - 1;
+        }
+    }
+    // merged attributes, reducible ones when every attribute implying them is present
+    for (a = 0; a < attribute_classes; a++) {
+        bool present;
+        int r = attribute_class_reduced[a];
+        if (r >= 0) {
+            present = (intent[BIT_WORD(r)] & BIT_MASK(r)) != 0;
+        } else {
+            uint64_t *required = &attribute_class_required[(size_t) a * attribute_words];
+            present = true;
+            for (w = 0; w < attribute_words && present; w++) {
+                present = (required[w] & ~intent[w]) == 0;
+            }
+        }
+        if (present) {
+            for (m = attribute_class_start[a]; m < attribute_class_start[a + 1]; m++) {
+                int o = attribute_class_members[m];
+                mapped_intent[BIT_WORD(o)] |= BIT_MASK(o);
+            }
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+// Bitset engine
+//
+// Extents and intents are packed 64-bit words, bit i of word i / 64 set when object (attribute) i is present.
+// The cross table is kept twice: by attribute (object column of each attribute) and by object (attribute row
+// of each object), so extents are built by word-wise AND and intents by word-wise subset tests.
+// ---------------------------------------------------------------------------------------------------------------------
+
+// pack cross table into attribute columns and object rows, rows kept when already loaded packed
+void packContext(void) {
+    int i, w;
+    if (bit_rows == NULL) {
+        packRows();
+    }
+    bit_columns = (uint64_t *) calloc((size_t) attribute_size * object_words, sizeof(uint64_t));
+    if (bit_columns == NULL) {
+        fprintf(stderr, "Error allocating packed cross table\n");
+        exit(EXIT_FAILURE);
+    }
+    // transpose rows into columns
+    for (i = 0; i < data_size; i++) {
+        uint64_t *row = &bit_rows[(size_t) i * attribute_words];
+        for (w = 0; w < attribute_words; w++) {
+            uint64_t bits = row[w];
+            while (bits != 0) {
+                int a = w * WORD_BITS + __builtin_ctzll(bits);
+                bit_columns[(size_t) a * object_words + BIT_WORD(i)] |= BIT_MASK(i);
+                bits &= bits - 1;
+            }
+        }
+    }
+}
+
+// pack cross table into object rows
+void packRows(void) {
+    int i, a;
+    bit_rows = (uint64_t *) calloc((size_t) data_size * attribute_words, sizeof(uint64_t));
+    if (bit_rows == NULL) {
+        fprintf(stderr, "Error allocating packed cross table\n");
+        exit(EXIT_FAILURE);
+    }
+    for (i = 0; i < data_size; i++) {
+        for (a = 0; a < attribute_size; a++) {
+            if (cross_table[((size_t) i * attribute_size) + a] == '1') {
+                bit_rows[(size_t) i * attribute_words + BIT_WORD(a)] |= BIT_MASK(a);
+            }
+        }
+    }
+}
+
+// bytes of the '0' / '1' cross table, exits when objects x attributes is too large to allocate
+size_t crossTableSize(void) {
+    if (data_size <= 0 || attribute_size <= 0 || (size_t) data_size > PTRDIFF_MAX / (size_t) attribute_size) {
+        fprintf(stderr, "Error allocating cross table: %d objects x %d attributes too large\n", data_size,
+                attribute_size);
+        exit(EXIT_FAILURE);
+    }
+    return (size_t) data_size * (size_t) attribute_size;
+}
+
+// unpack object rows into the '0' / '1' cross table
+void unpackContext(void) {
+    int i, a;
+    cross_table = (char *) malloc(crossTableSize());
+    if (cross_table == NULL) {
+        fprintf(stderr, "Error allocating cross table\n");
+        exit(EXIT_FAILURE);
+    }
+    for (i = 0; i < data_size; i++) {
+        for (a = 0; a < attribute_size; a++) {
+            bool present = (bit_rows[(size_t) i * attribute_words + BIT_WORD(a)] & BIT_MASK(a)) != 0;
+            cross_table[((size_t) i * attribute_size) + a] = present ? '1' : '0';
+        }
+    }
+}
+
+// build up initial concept on bitsets
+// out: objects, attributes
+void buildInitialConceptBits(uint64_t *obj, uint64_t *attr) {
+    int i;
+    // all objects (X)
+    memset(obj, 0, object_words * sizeof(uint64_t));
+    for (i = 0; i < data_size; i++) {
+        obj[BIT_WORD(i)] |= BIT_MASK(i);
+    }
+    // common attributes of all objects (X up), AND of every object row
+    memset(attr, 0, attribute_words * sizeof(uint64_t));
+    for (i = 0; i < attribute_size; i++) {
+        attr[BIT_WORD(i)] |= BIT_MASK(i);
+    }
+    for (i = 0; i < data_size; i++) {
+        kernels.intersect(attr, attr, &bit_rows[(size_t) i * attribute_words], attribute_words);
+    }
+}
+
+/**
+ * Close-by-One Algorithm on bitsets
+ *
+ * The recursion runs on an explicit stack, the concept at depth d and the attribute to try next live in frame d
+ * of the arena, so nothing is allocated per concept and the depth does not depend on the thread stack size.
+ *
+ * input :  1. stack frames
+ *          2. object set
+ *          3. attribute set
+ *          4. current attribute index
+ */
+void computeConceptFromBits(arena_t *arena, uint64_t *obj, uint64_t *attr, int attr_index) {
+    int depth = 0;
+    frame_t *frame;
+    if (resuming) {
+        // 1. rebuild the stack of the interrupted run, its concepts are output already
+        depth = restoreCheckpoint(arena, obj, attr);
+    } else {
+        // 1. Process Concept
+        frame = frameAt(arena, 0);
+        memcpy(frame->extent, obj, object_words * sizeof(uint64_t));
+        memcpy(frame->intent, attr, attribute_words * sizeof(uint64_t));
+        frame->attr_index = attr_index;
+        STATS_DEPTH(0);
+        frame->id = ownsRoot(arena) ? processConceptBits(frame->extent, frame->intent, -1) : -1;
+    }
+    while (depth >= 0) {
+        if (checkpoint_path != NULL && checkpointDue()) {
+            saveCheckpoint(arena, depth); // frames up to depth hold the whole remaining search
+            if (interrupted) {
+                return;
+            }
+        }
+        frame = &arena->frames[depth];
+        // 2. go through remaining attributes of the concept on top of the stack
+        bool descended = false;
+        STATS_DEPTH(depth + 1);
+        while (frame->attr_index < attribute_size) {
+            int j = frame->attr_index++;
+            // 3. check current attribute exist or not, and root branch belongs to this shard
+            if (checkAttributeBits(j, frame->intent) || !ownsBranch(arena, depth, j)) {
+                continue;
+            }
+            // 4. make extent in the next frame
+            frame_t *child = frameAt(arena, depth + 1);
+            makeExtentBits(child->extent, frame->extent, j);
+            if (!isFrequentBits(child->extent)) {
+                continue; // below minimum support, cut before closing
+            }
+            // 5. make intent fused with canonicity test
+            if (closeAndTestBits(child->intent, child->extent, frame->intent, j)) {
+                // 6. push child, process it and continue from its first attribute
+                child->attr_index = j + 1;
+                child->id = processConceptBits(child->extent, child->intent, frame->id);
+                depth++;
+                descended = true;
+                break;
+            }
+        }
+        if (!descended) {
+            depth--; // attributes exhausted, pop
+        }
+    }
+}
+
+// prepare arena with frames for every depth, buffers are allocated on first use
+void openArena(arena_t *arena) {
+    arena->frames = (frame_t *) calloc(attribute_size + 1, sizeof(frame_t));
+    arena->no_failing = (int *) malloc(attribute_size * sizeof(int));
+    arena->allocated = 0;
+    arena->sharded = false;
+    if (arena->frames == NULL || arena->no_failing == NULL) {
+        fprintf(stderr, "Error allocating stack frames\n");
+        exit(EXIT_FAILURE);
+    }
+    memset(arena->no_failing, -1, attribute_size * sizeof(int));
+}
+
+// release every frame buffer of the arena
+void closeArena(arena_t *arena) {
+    int d;
+    for (d = 0; d < arena->allocated; d++) {
+        frame_t *frame = &arena->frames[d];
+        if (engine == ENGINE_FCBO) {
+            free(frame->extents);
+            free(frame->intents);
+            free(frame->failing);
+            free(frame->queue);
+        } else if (engine == ENGINE_INCLOSE) {
+            free(frame->extents);
+            free(frame->intent);
+            free(frame->failing);
+            free(frame->queue);
+        } else {
+            free(frame->extent);
+            free(frame->intent);
+            free(frame->tids);
+        }
+    }
+    free(arena->frames);
+    free(arena->no_failing);
+    arena->frames = NULL;
+    arena->no_failing = NULL;
+    arena->allocated = 0;
+}
+
+// frame of given depth, allocating its buffers the first time the depth is reached
+frame_t *frameAt(arena_t *arena, int depth) {
+    frame_t *frame = &arena->frames[depth];
+    if (depth < arena->allocated) {
+        return frame;
+    }
+    // depths are reached one at a time
+    if (engine == ENGINE_FCBO) {
+        // closure slots of every attribute, children point into them
+        frame->extents = (uint64_t *) malloc((size_t) attribute_size * object_words * sizeof(uint64_t));
+        frame->intents = (uint64_t *) malloc((size_t) attribute_size * attribute_words * sizeof(uint64_t));
+        frame->failing = (int *) malloc(attribute_size * sizeof(int));
+        frame->queue = (int *) malloc(attribute_size * sizeof(int));
+        if (frame->extents == NULL || frame->intents == NULL || frame->failing == NULL || frame->queue == NULL) {
+            fprintf(stderr, "Error allocating stack frame %d\n", depth);
+            exit(EXIT_FAILURE);
+        }
+    } else if (engine == ENGINE_INCLOSE) {
+        // child extent slots of every attribute, own intent completed by partial closure
+        frame->extents = (uint64_t *) malloc((size_t) attribute_size * object_words * sizeof(uint64_t));
+        frame->intent = (uint64_t *) malloc(attribute_words * sizeof(uint64_t));
+        frame->failing = (int *) malloc(attribute_size * sizeof(int));
+        frame->queue = (int *) malloc(attribute_size * sizeof(int));
+        if (frame->extents == NULL || frame->intent == NULL || frame->failing == NULL || frame->queue == NULL) {
+            fprintf(stderr, "Error allocating stack frame %d\n", depth);
+            exit(EXIT_FAILURE);
+        }
+    } else {
+        frame->extent = (uint64_t *) calloc(object_words, sizeof(uint64_t));
+        frame->intent = (uint64_t *) malloc(attribute_words * sizeof(uint64_t));
+        if (engine == ENGINE_SPARSE) {
+            frame->tids = (int *) malloc((data_size + 1) * sizeof(int));
+        }
+        if (frame->extent == NULL || frame->intent == NULL || (engine == ENGINE_SPARSE && frame->tids == NULL)) {
+            fprintf(stderr, "Error allocating stack frame %d\n", depth);
+            exit(EXIT_FAILURE);
+        }
+    }
+    arena->allocated = depth + 1;
+    return frame;
+}
+
+// store concept
+long processConceptBits(uint64_t *obj, uint64_t *attr, long parent) {
+    emitConcept(obj, attr);
+    return (lattice_path != NULL) ? storeConcept(&lattice, obj, attr, parent) : -1;
+}
+
+// check attribute contains on attribute set or not
+bool checkAttributeBits(int j, uint64_t *attr) {
+    return (attr[BIT_WORD(j)] & BIT_MASK(j)) != 0;
+}
+
+// make extent, objects of obj having attribute attr_index
+void makeExtentBits(uint64_t *extent, uint64_t *obj, int attr_index) {
+    STATS_START(timer);
+    kernels.intersect(extent, obj, &bit_columns[(size_t) attr_index * object_words], object_words);
+    STATS_STOP(timer, STAT_EXTENT);
+}
+
+// check extent reaches the minimum support
+bool isFrequentBits(uint64_t *extent) {
+    return min_support == 0 || kernels.popcount(extent, object_words) >= min_support;
+}
+
+// make intent, attributes whose column contains every object of extent
+void makeIntentBits(uint64_t *intent, uint64_t *extent) {
+    int a;
+    STATS_START(timer);
+    memset(intent, 0, attribute_words * sizeof(uint64_t));
+    for (a = 0; a < attribute_size; a++) {
+        if (isExtentInColumnBits(extent, a)) {
+            intent[BIT_WORD(a)] |= BIT_MASK(a);
+        }
+    }
+    STATS_STOP(timer, STAT_INTENT);
+}
+
+// check every object of extent has attribute attr_index
+bool isExtentInColumnBits(uint64_t *extent, int attr_index) {
+    return kernels.subset(extent, &bit_columns[(size_t) attr_index * object_words], object_words);
+}
+
+
+// make intent fused with canonicity test, intent is complete only when true is returned, copied to libcbo.c
+bool closeAndTestBits(uint64_t *intent, uint64_t *extent, uint64_t *attr, int attr_index) {
+    return closeOrFailingBits(intent, extent, attr, attr_index) < 0;
+}
+
+/**
+ * make intent fused with canonicity test, keeping the attribute that failed it
+ *
+ * Attributes of attr are in the closure of any extent taken from attr's objects, so only the others are tested.
+ * Those below attr_index are tested first and the first one found rejects the candidate, the intent is finished
+ * from attr_index on only when none is found.
+ *
+ * input :  1. intent to fill, complete only when -1 is returned
+ *          2. extent of the candidate
+ *          3. attribute set of the parent concept
+ *          4. current attribute index
+ *
+ * returns -1 when canonical, else the attribute below attr_index missing from attr whose column holds the extent
+ */
+int closeOrFailingBits(uint64_t *intent, uint64_t *extent, uint64_t *attr, int attr_index) {
+    int w;
+    int split_word = BIT_WORD(attr_index);
+    uint64_t below = BIT_MASK(attr_index) - 1; // bits below attr_index in the split word
+    uint64_t last = (attribute_size % WORD_BITS != 0) ? BIT_MASK(attribute_size) - 1 : ~0ULL; // valid bits of last word
+    STATS_START(timer);
+    // 1. attributes below attr_index, rejected on the first new one
+    for (w = 0; w <= split_word && w < attribute_words; w++) {
+        uint64_t candidates = ~attr[w];
+        if (w == split_word) {
+            candidates &= below;
+        }
+        while (candidates != 0) {
+            int a = w * WORD_BITS + __builtin_ctzll(candidates);
+            if (isExtentInColumnBits(extent, a)) {
+                STATS_STOP(timer, STAT_FUSED);
+                STATS_FAILURE();
+                return a;
+            }
+            candidates &= candidates - 1;
+        }
+    }
+    // 2. canonical, finish attributes from attr_index on
+    memcpy(intent, attr, attribute_words * sizeof(uint64_t));
+    for (w = split_word; w < attribute_words; w++) {
+        uint64_t candidates = ~attr[w];
+        if (w == split_word) {
+            candidates &= ~below;
+        }
+        if (w == attribute_words - 1) {
+            candidates &= last;
+        }
+        while (candidates != 0) {
+            int a = w * WORD_BITS + __builtin_ctzll(candidates);
+            if (isExtentInColumnBits(extent, a)) {
+                intent[w] |= BIT_MASK(a);
+            }
+            candidates &= candidates - 1;
+        }
+    }
+    STATS_STOP(timer, STAT_FUSED);
+    return -1;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+// In-Close
+//
+// In-Close3 (Andrews). The intent of a concept is completed while its attributes are tried: an attribute whose
+// column holds the whole extent is added to the intent in place (partial closure) instead of closing a child, and
+// only the extent of a child is computed, its intent is the completed parent intent plus the attribute. The
+// canonicity test looks for an attribute below j outside the intent whose column holds the child extent, and the
+// attribute found is handed down: a descendant skips j while that attribute is still missing from its intent.
+// ---------------------------------------------------------------------------------------------------------------------
+
+/**
+ * In-Close Algorithm
+ *
+ * Runs on an explicit stack like computeConceptFromFast. Frame d keeps the child extents of its concept in per
+ * attribute slots and completes its own intent, a concept is output once its attributes are tried.
+ *
+ * input :  1. stack frames
+ *          2. object set
+ *          3. attribute set
+ */
+void computeConceptFromInClose(arena_t *arena, uint64_t *obj, uint64_t *attr) {
+    int depth = 0;
+    frame_t *frame = frameAt(arena, 0);
+    frame->extent = obj;
+    memcpy(frame->intent, attr, attribute_words * sizeof(uint64_t));
+    frame->attr_index = 0;
+    // 1. try attributes of the root, output it and queue its children
+    STATS_DEPTH(1);
+    expandConceptInClose(frame, arena->no_failing);
+    STATS_DEPTH(0);
+    frame->id = ownsRoot(arena) ? processConceptBits(frame->extent, frame->intent, -1) : -1;
+    while (depth >= 0) {
+        frame = &arena->frames[depth];
+        if (frame->next == frame->queued) {
+            depth--; // children exhausted, pop
+            continue;
+        }
+        // 2. push next queued child, intent is the completed parent intent plus j
+        int j = frame->queue[frame->next++];
+        if (!ownsBranch(arena, depth, j)) {
+            continue; // root branch of another shard
+        }
+        frame_t *child = frameAt(arena, depth + 1);
+        child->extent = &frame->extents[(size_t) j * object_words];
+        memcpy(child->intent, frame->intent, attribute_words * sizeof(uint64_t));
+        child->intent[BIT_WORD(j)] |= BIT_MASK(j);
+        child->attr_index = j + 1;
+        STATS_DEPTH(depth + 2);
+        expandConceptInClose(child, frame->failing);
+        STATS_DEPTH(depth + 1);
+        child->id = processConceptBits(child->extent, child->intent, frame->id);
+        depth++;
+    }
+}
+
+/**
+ * try attributes from the frame attribute index, completing the intent and queueing canonical children
+ *
+ * input :  1. frame holding the concept
+ *          2. failing attribute per attribute inherited from the parent
+ */
+void expandConceptInClose(frame_t *frame, int *failing) {
+    int j;
+    memcpy(frame->failing, failing, attribute_size * sizeof(int));
+    frame->queued = 0;
+    frame->next = 0;
+    for (j = frame->attr_index; j < attribute_size; j++) {
+        // check current attribute exist or not
+        if (checkAttributeBits(j, frame->intent)) {
+            continue;
+        }
+        // skip attribute whose failing attribute is still missing, attributes below j are final
+        if (failing[j] >= 0 && !checkAttributeBits(failing[j], frame->intent)) {
+            STATS_COUNT(inherited_skips);
+            continue;
+        }
+        // partial closure, every object has j
+        if (isExtentInColumnBits(frame->extent, j)) {
+            frame->intent[BIT_WORD(j)] |= BIT_MASK(j);
+            continue;
+        }
+        uint64_t *extent = &frame->extents[(size_t) j * object_words];
+        makeExtentBits(extent, frame->extent, j);
+        if (!isFrequentBits(extent)) {
+            continue; // below minimum support
+        }
+        // do canonicity test, queue child or remember the attribute failing it
+        int failed = failingAttributeBits(extent, frame->intent, j);
+        if (failed < 0) {
+            frame->queue[frame->queued++] = j;
+        } else {
+            frame->failing[j] = failed;
+        }
+    }
+}
+
+// attribute below attr_index missing from intent whose column holds the extent, -1 when canonical
+int failingAttributeBits(uint64_t *extent, uint64_t *intent, int attr_index) {
+    int w;
+    int split_word = BIT_WORD(attr_index);
+    STATS_START(timer);
+    for (w = 0; w <= split_word && w < attribute_words; w++) {
+        uint64_t candidates = ~intent[w];
+        if (w == split_word) {
+            candidates &= BIT_MASK(attr_index) - 1;
+        }
+        while (candidates != 0) {
+            int a = w * WORD_BITS + __builtin_ctzll(candidates);
+            if (isExtentInColumnBits(extent, a)) {
+                STATS_STOP(timer, STAT_CANONICITY);
+                STATS_FAILURE();
+                return a;
+            }
+            candidates &= candidates - 1;
+        }
+    }
+    STATS_STOP(timer, STAT_CANONICITY);
+    return -1;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+// Sharding
+//
+// Several processes split one enumeration. The canonical children of the root concept start the branches, each
+// branch is estimated by its concepts in the first SHARD_ESTIMATE_DEPTH levels, and the branches are dealt to the
+// shards longest first, each to the least loaded shard. Every process computes the same plan from the same context
+// and options and only descends its own branches, shard 0 also outputs the root concept. The shard outputs together
+// hold the concept set of a single run.
+// ---------------------------------------------------------------------------------------------------------------------
+
+// assign root branches to shards by estimated cost
+void planShards(uint64_t *obj, uint64_t *attr) {
+    int j, k, b;
+    branch_shard = (int *) malloc(attribute_size * sizeof(int));
+    int *branches = (int *) malloc(attribute_size * sizeof(int));
+    long *cost = (long *) calloc(attribute_size, sizeof(long));
+    long *load = (long *) calloc(shard_count, sizeof(long));
+    uint64_t *extent = (uint64_t *) malloc(object_words * sizeof(uint64_t));
+    uint64_t *intent = (uint64_t *) malloc(attribute_words * sizeof(uint64_t));
+    int branch_count = 0;
+    // 1. canonical children of the root and their estimates
+    for (j = 0; j < attribute_size; j++) {
+        branch_shard[j] = -1;
+        if (checkAttributeBits(j, attr)) {
+            continue;
+        }
+        makeExtentBits(extent, obj, j);
+        if (!isFrequentBits(extent) || !closeAndTestBits(intent, extent, attr, j)) {
+            continue;
+        }
+        cost[j] = countBranch(extent, intent, j + 1, SHARD_ESTIMATE_DEPTH);
+        branches[branch_count++] = j;
+    }
+    // 2. longest first, ties by attribute, insertion sort keeps the order deterministic
+    for (b = 1; b < branch_count; b++) {
+        int current = branches[b];
+        k = b - 1;
+        while (k >= 0 && cost[branches[k]] < cost[current]) {
+            branches[k + 1] = branches[k];
+            k--;
+        }
+        branches[k + 1] = current;
+    }
+    // 3. each to the least loaded shard, ties by shard index
+    for (b = 0; b < branch_count; b++) {
+        int least = 0;
+        for (k = 1; k < shard_count; k++) {
+            if (load[k] < load[least]) {
+                least = k;
+            }
+        }
+        branch_shard[branches[b]] = least;
+        load[least] += cost[branches[b]];
+    }
+    if (verbose) {
+        long total = 0;
+        int owned = 0;
+        for (b = 0; b < branch_count; b++) {
+            total += cost[branches[b]];
+            owned += branch_shard[branches[b]] == shard_index;
+        }
+        printf("shard %d/%d : %d of %d root branches, estimated cost %ld of %ld\n\n", shard_index, shard_count, owned,
+               branch_count, load[shard_index], total);
+    }
+    free(branches);
+    free(cost);
+    free(load);
+    free(extent);
+    free(intent);
+}
+
+/**
+ * count concepts in the first levels of a branch, later levels grow with them
+ *
+ * input :  1. object set
+ *          2. attribute set
+ *          3. current attribute index
+ *          4. levels to count, the concept itself included
+ */
+long countBranch(uint64_t *extent, uint64_t *intent, int attr_index, int levels) {
+    int j;
+    long count = 1;
+    if (levels <= 1) {
+        return count;
+    }
+    uint64_t child_extent[object_words];
+    uint64_t child_intent[attribute_words];
+    for (j = attr_index; j < attribute_size; j++) {
+        if (checkAttributeBits(j, intent)) {
+            continue;
+        }
+        makeExtentBits(child_extent, extent, j);
+        if (isFrequentBits(child_extent) && closeAndTestBits(child_intent, child_extent, intent, j)) {
+            count += countBranch(child_extent, child_intent, j + 1, levels - 1);
+        }
+    }
+    return count;
+}
+
+// check root concept of the arena is output by this shard
+bool ownsRoot(arena_t *arena) {
+    return !arena->sharded || shard_index == 0;
+}
+
+// check branch through attribute j of the concept at given depth is descended by this shard
+bool ownsBranch(arena_t *arena, int depth, int j) {
+    return depth > 0 || !arena->sharded || branch_shard[j] == shard_index;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+// Checkpoints
+//
+// The bits engine keeps its whole remaining search in the explicit stack: frame d holds the next attribute to try,
+// and the concept of frame d + 1 is the closure of frame d extended by the attribute before it. A checkpoint is the
+// list of next attributes plus the concepts already output and the output bytes holding them, so it is a few
+// hundred bytes whatever the context. The output is drained to disk first and the file is replaced by rename, a
+// crash leaves the previous checkpoint. On resume the output is cut back to the checkpoint offset and the stack is
+// rebuilt by one extent and closure per level, no concept is output twice.
+// ---------------------------------------------------------------------------------------------------------------------
+
+// read checkpoint of an interrupted run, false when there is none
+bool loadCheckpoint(char *file_path) {
+    uint32_t d;
+    FILE *file = fopen(file_path, "rb");
+    if (file == NULL) {
+        int err_num = errno;
+        if (err_num == ENOENT) {
+            return false;
+        }
+        fprintf(stderr, "Error opening file: %s: %s\n", file_path, strerror(err_num));
+        exit(EXIT_FAILURE);
+    }
+    checkpoint_header_t *header = &resume_header;
+    if (fread(header, sizeof(checkpoint_header_t), 1, file) != 1
+        || memcmp(header->magic, CHECKPOINT_MAGIC, sizeof(header->magic)) != 0
+        || header->version != CHECKPOINT_VERSION) {
+        fprintf(stderr, "Error reading file: %s: not a checkpoint\n", file_path);
+        exit(EXIT_FAILURE);
+    }
+    if (header->objects != (uint32_t) data_size || header->attributes != (uint32_t) attribute_size
+        || header->context_hash != checkpoint_context_hash) {
+        fprintf(stderr, "Error resuming: %s: checkpoint of another context\n", file_path);
+        exit(EXIT_FAILURE);
+    }
+    if (header->sink_kind != (int32_t) sink_kind || header->min_support != min_support
+        || header->shard_index != shard_index || header->shard_count != shard_count) {
+        fprintf(stderr, "Error resuming: %s: checkpoint of a run with other -o, -m or -s options\n", file_path);
+        exit(EXIT_FAILURE);
+    }
+    if (header->frames < 1 || header->frames > (uint32_t) attribute_size + 1) {
+        fprintf(stderr, "Error reading file: %s: corrupt checkpoint\n", file_path);
+        exit(EXIT_FAILURE);
+    }
+    resume_attr_index = (uint32_t *) malloc(header->frames * sizeof(uint32_t));
+    if (fread(resume_attr_index, sizeof(uint32_t), header->frames, file) != header->frames) {
+        fprintf(stderr, "Error reading file: %s: corrupt checkpoint\n", file_path);
+        exit(EXIT_FAILURE);
+    }
+    fclose(file);
+    for (d = 0; d < header->frames; d++) {
+        // next attributes in range, frames below the top descended through the attribute before theirs
+        if (resume_attr_index[d] > (uint32_t) attribute_size || (d + 1 < header->frames && resume_attr_index[d] == 0)) {
+            fprintf(stderr, "Error reading file: %s: corrupt checkpoint\n", file_path);
+            exit(EXIT_FAILURE);
+        }
+    }
+    return true;
+}
+
+// check a checkpoint is asked for, reading the clock once every CHECKPOINT_TICKS stack steps
+bool checkpointDue(void) {
+    if (interrupted) {
+        return true;
+    }
+    if (++checkpoint_ticks < CHECKPOINT_TICKS) {
+        return false;
+    }
+    checkpoint_ticks = 0;
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return elapsedSeconds(&checkpoint_time, &now) >= checkpoint_interval;
+}
+
+/**
+ * write checkpoint of the bits engine, replacing the previous one once complete
+ *
+ * input :  1. stack frames
+ *          2. depth of the top frame
+ */
+void saveCheckpoint(arena_t *arena, int depth) {
+    int d;
+    checkpoint_header_t header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, CHECKPOINT_MAGIC, sizeof(header.magic));
+    header.version = CHECKPOINT_VERSION;
+    header.objects = data_size;
+    header.attributes = attribute_size;
+    header.context_hash = checkpoint_context_hash;
+    header.sink_kind = sink_kind;
+    header.min_support = min_support;
+    header.shard_index = shard_index;
+    header.shard_count = shard_count;
+    // 1. every concept output so far on disk
+    header.output_offset = (uint64_t) drainOutput();
+    header.concept_count = (uint64_t) main_sink.concept_count;
+    header.frames = depth + 1;
+    uint32_t next[depth + 1];
+    for (d = 0; d <= depth; d++) {
+        next[d] = (uint32_t) arena->frames[d].attr_index;
+    }
+    // 2. write aside and rename over the previous checkpoint
+    char temporary_path[strlen(checkpoint_path) + 5];
+    snprintf(temporary_path, sizeof(temporary_path), "%s.tmp", checkpoint_path);
+    FILE *file = fopen(temporary_path, "wb");
+    if (file == NULL) {
+        int err_num = errno;
+        fprintf(stderr, "Error opening file: %s: %s\n", temporary_path, strerror(err_num));
+        exit(EXIT_FAILURE);
+    }
+    bool status = fwrite(&header, sizeof(header), 1, file) == 1
+                  && fwrite(next, sizeof(uint32_t), (size_t) depth + 1, file) == (size_t) depth + 1
+                  && fflush(file) == 0 && fsync(fileno(file)) == 0;
+    int err_num = errno;
+    if (fclose(file) != 0 && status) {
+        status = false;
+        err_num = errno;
+    }
+    if (status && rename(temporary_path, checkpoint_path) != 0) {
+        status = false;
+        err_num = errno;
+    }
+    if (!status) {
+        // the previous checkpoint is left untouched, a resume still starts from it
+        remove(temporary_path);
+        fprintf(stderr, "Error writing file: %s: %s\n", checkpoint_path, strerror(err_num));
+        exit(EXIT_FAILURE);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &checkpoint_time);
+}
+
+/**
+ * rebuild the stack of the bits engine from the loaded checkpoint, returns depth of the top frame
+ *
+ * input :  1. stack frames
+ *          2. object set of the root concept
+ *          3. attribute set of the root concept
+ */
+int restoreCheckpoint(arena_t *arena, uint64_t *obj, uint64_t *attr) {
+    int d;
+    int depth = (int) resume_header.frames - 1;
+    frame_t *frame = frameAt(arena, 0);
+    memcpy(frame->extent, obj, object_words * sizeof(uint64_t));
+    memcpy(frame->intent, attr, attribute_words * sizeof(uint64_t));
+    frame->attr_index = (int) resume_attr_index[0];
+    frame->id = -1;
+    for (d = 1; d <= depth; d++) {
+        frame_t *parent = &arena->frames[d - 1];
+        frame = frameAt(arena, d);
+        // frame d was pushed by its parent through the attribute before the parent's next one
+        int j = parent->attr_index - 1;
+        makeExtentBits(frame->extent, parent->extent, j);
+        if (checkAttributeBits(j, parent->intent) || !isFrequentBits(frame->extent)
+            || !closeAndTestBits(frame->intent, frame->extent, parent->intent, j)) {
+            fprintf(stderr, "Error resuming: %s: frame %d is not a canonical child of its parent\n", checkpoint_path,
+                    d);
+            exit(EXIT_FAILURE);
+        }
+        frame->attr_index = (int) resume_attr_index[d];
+        frame->id = -1;
+    }
+    free(resume_attr_index);
+    resume_attr_index = NULL;
+    return depth;
+}
+
+// hash of the packed object rows, identifies the enumerated context
+uint64_t contextHash(void) {
+    int i;
+    uint64_t hash = 1469598103934665603ULL;
+    for (i = 0; i < data_size; i++) {
+        hash = (hash ^ hashBits(&bit_rows[(size_t) i * attribute_words], attribute_words)) * 1099511628211ULL;
+    }
+    return hash;
+}
+
+// SIGINT and SIGTERM handler, the engine checkpoints and stops at its next step
+void requestCheckpoint(int signal_number) {
+    interrupted = 1;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+// Incremental update
+//
+// Objects appended to a context are added to its stored concepts one at a time, as in Godin, Missaoui and Alaoui
+// (1995): a new object g with row R changes exactly the concepts whose intent lies in R. Those already stored gain g,
+// the others are new. Instead of testing every stored intent against R, Close-by-One restricted to the attributes of
+// R and the objects up to g enumerates just these concepts, and each is looked up by intent in the hash table of the
+// lattice store. Work grows with the concepts of g, not with the stored lattice.
+// ---------------------------------------------------------------------------------------------------------------------
+
+/**
+ * read the stored concepts of the first objects, add every object after them and output the grown concept set
+ *
+ * input :  1. binary concept stream of the first objects
+ */
+void updateConcepts(char *file_path) {
+    long c;
+    int g;
+    uint32_t stored_objects;
+    // 1. stored concepts, extents sized for the grown context
+    openLattice(&lattice);
+    readConceptStream(&lattice, file_path, &stored_objects);
+    long stored = lattice.count;
+    long table_size = 0;
+    long *table = growTable(&lattice, NULL, &table_size);
+    // 2. one appended object at a time, on a stack of one level per attribute
+    uint64_t *extents = (uint64_t *) malloc((size_t) (attribute_size + 1) * object_words * sizeof(uint64_t));
+    uint64_t *intents = (uint64_t *) malloc((size_t) (attribute_size + 1) * attribute_words * sizeof(uint64_t));
+    int *next = (int *) malloc((attribute_size + 1) * sizeof(int));
+    if (extents == NULL || intents == NULL || next == NULL) {
+        fprintf(stderr, "Error allocating update stack\n");
+        exit(EXIT_FAILURE);
+    }
+    for (g = (int) stored_objects; g < data_size; g++) {
+        table = addObject(&lattice, g, table, &table_size, extents, intents, next);
+    }
+    free(extents);
+    free(intents);
+    free(next);
+    // 3. output the grown concept set, kept in the store for the update check
+    for (c = 0; c < lattice.count; c++) {
+        emitConcept(&lattice.extents[(size_t) c * object_words], &lattice.intents[(size_t) c * attribute_words]);
+    }
+    printf("update : %d objects added to %ld stored concepts, %ld new\n\n", data_size - (int) stored_objects, stored,
+           lattice.count - stored);
+    free(table);
+}
+
+/**
+ * read binary concept stream into the store, extents widened to the loaded objects
+ *
+ * input :  1. lattice store
+ *          2. binary concept stream
+ * out: objects of the context the stream was enumerated from
+ */
+void readConceptStream(lattice_t *store, char *file_path, uint32_t *objects) {
+    uint32_t i;
+    FILE *file = fopen(file_path, "rb");
+    if (file == NULL) {
+        int err_num = errno;
+        fprintf(stderr, "Error opening file: %s: %s\n", file_path, strerror(err_num));
+        exit(EXIT_FAILURE);
+    }
+    concept_stream_header_t header;
+    if (fread(&header, sizeof(header), 1, file) != 1
+        || memcmp(header.magic, CONCEPT_STREAM_MAGIC, sizeof(header.magic)) != 0
+        || header.version != CONCEPT_STREAM_VERSION) {
+        fprintf(stderr, "Error reading file: %s: not a binary concept stream\n", file_path);
+        exit(EXIT_FAILURE);
+    }
+    if (header.attributes != (uint32_t) attribute_size || header.objects > (uint32_t) data_size) {
+        fprintf(stderr, "Error updating: %s: concepts of a %u x %u context, %d x %d loaded\n", file_path,
+                header.objects, header.attributes, data_size, attribute_size);
+        exit(EXIT_FAILURE);
+    }
+    *objects = header.objects;
+    uint32_t *record = (uint32_t *) malloc(((size_t) header.objects + header.attributes + 2) * sizeof(uint32_t));
+    uint64_t *extent = (uint64_t *) malloc(object_words * sizeof(uint64_t));
+    uint64_t *intent = (uint64_t *) malloc(attribute_words * sizeof(uint64_t));
+    while (fread(record, sizeof(uint32_t), 2, file) == 2) {
+        // extent size, intent size, then the indices
+        uint32_t *indices = record + 2;
+        size_t count = (size_t) record[0] + record[1];
+        bool valid = record[0] <= header.objects && record[1] <= header.attributes
+                     && fread(indices, sizeof(uint32_t), count, file) == count;
+        memset(extent, 0, object_words * sizeof(uint64_t));
+        memset(intent, 0, attribute_words * sizeof(uint64_t));
+        for (i = 0; valid && i < record[0]; i++) {
+            valid = indices[i] < header.objects;
+            extent[BIT_WORD(indices[i])] |= valid ? BIT_MASK(indices[i]) : 0;
+        }
+        for (i = record[0]; valid && i < count; i++) {
+            valid = indices[i] < header.attributes;
+            intent[BIT_WORD(indices[i])] |= valid ? BIT_MASK(indices[i]) : 0;
+        }
+        if (!valid) {
+            fprintf(stderr, "Error reading file: %s: corrupt concept record %ld\n", file_path, store->count);
+            exit(EXIT_FAILURE);
+        }
+        storeConcept(store, extent, intent, -1);
+    }
+    if (ferror(file)) {
+        int err_num = errno;
+        fprintf(stderr, "Error reading file: %s: %s\n", file_path, strerror(err_num));
+        exit(EXIT_FAILURE);
+    }
+    fclose(file);
+    free(record);
+    free(extent);
+    free(intent);
+}
+
+/**
+ * add one object to the stored concepts, returns the intent hash table, grown when needed
+ *
+ * Close-by-One over the attributes of the object and the objects up to it finds every concept the object belongs
+ * to, each either a stored intent gaining the object or a new concept.
+ *
+ * input :  1. lattice store
+ *          2. object, its row in the loaded context
+ *          3. intent hash table of the store
+ *          4. table size
+ *          5. stack of extents, intents and next attributes, attribute_size + 1 levels
+ */
+long *addObject(lattice_t *store, int object, long *table, long *table_size, uint64_t *extents, uint64_t *intents,
+                int *next) {
+    int i, j;
+    int depth = 0;
+    uint64_t *row = &bit_rows[(size_t) object * attribute_words];
+    // 1. root, objects up to the new one and their common attributes
+    memset(extents, 0, object_words * sizeof(uint64_t));
+    for (i = 0; i <= object; i++) {
+        extents[BIT_WORD(i)] |= BIT_MASK(i);
+    }
+    makeIntentBits(intents, extents);
+    table = mergeConcept(store, extents, intents, table, table_size);
+    next[0] = 0;
+    while (depth >= 0) {
+        uint64_t *extent = &extents[(size_t) depth * object_words];
+        uint64_t *intent = &intents[(size_t) depth * attribute_words];
+        bool descended = false;
+        while (next[depth] < attribute_size) {
+            j = next[depth]++;
+            // 2. attributes of the object only, intents outside its row do not hold it
+            if (checkAttributeBits(j, intent) || !checkAttributeBits(j, row)) {
+                continue;
+            }
+            uint64_t *child_extent = extent + object_words;
+            uint64_t *child_intent = intent + attribute_words;
+            makeExtentBits(child_extent, extent, j);
+            if (closeAndTestBits(child_intent, child_extent, intent, j)) {
+                // 3. stored intent gains the object, or new concept
+                table = mergeConcept(store, child_extent, child_intent, table, table_size);
+                next[++depth] = j + 1;
+                descended = true;
+                break;
+            }
+        }
+        if (!descended) {
+            depth--;
+        }
+    }
+    return table;
+}
+
+// put concept into the store, replacing the extent of a stored concept with the same intent, returns the intent
+// hash table, grown when needed
+long *mergeConcept(lattice_t *store, uint64_t *extent, uint64_t *intent, long *table, long *table_size) {
+    long id = findConcept(store, table, *table_size, intent);
+    if (id >= 0) {
+        memcpy(&store->extents[(size_t) id * object_words], extent, object_words * sizeof(uint64_t));
+        return table;
+    }
+    id = storeConcept(store, extent, intent, -1);
+    if (2 * store->count > *table_size) {
+        return growTable(store, table, table_size);
+    }
+    insertConcept(store, table, *table_size, id);
+    return table;
+}
+
+// put stored concept into the intent hash table
+void insertConcept(lattice_t *store, long *table, long table_size, long id) {
+    long slot = (long) (hashBits(&store->intents[(size_t) id * attribute_words], attribute_words) & (table_size - 1));
+    while (table[slot] != -1) {
+        slot = (slot + 1) & (table_size - 1);
+    }
+    table[slot] = id;
+}
+
+// intent hash table of every stored concept, power of two at most half full, replacing the given one
+long *growTable(lattice_t *store, long *table, long *table_size) {
+    long c;
+    free(table);
+    *table_size = 1;
+    while (*table_size < 2 * store->count + 2) {
+        *table_size <<= 1;
+    }
+    table = (long *) malloc(*table_size * sizeof(long));
+    if (table == NULL) {
+        fprintf(stderr, "Error allocating intent hash table of %ld slots\n", *table_size);
+        exit(EXIT_FAILURE);
+    }
+    for (c = 0; c < *table_size; c++) {
+        table[c] = -1;
+    }
+    for (c = 0; c < store->count; c++) {
+        insertConcept(store, table, *table_size, c);
+    }
+    return table;
+}
+
+/**
+ * compare the updated concepts with a full enumeration of the loaded context, both as count and digest
+ *
+ * input :  1. object set of the initial concept
+ *          2. attribute set of the initial concept
+ */
+bool verifyUpdate(uint64_t *obj, uint64_t *attr) {
+    long c;
+    struct timespec from, to;
+    sink_t updated;
+    memset(&updated, 0, sizeof(updated));
+    for (c = 0; c < lattice.count; c++) {
+        emitDigest(&updated, &lattice.extents[(size_t) c * object_words],
+                   &lattice.intents[(size_t) c * attribute_words]);
+    }
+    // 1. enumerate into a digest, the output of the update is complete
+    long output_count = main_sink.concept_count;
+    void (*emit)(sink_t *sink, uint64_t *extent, uint64_t *intent) = main_sink.emit;
+    main_sink.emit = emitDigest;
+    main_sink.concept_count = 0;
+    main_sink.digest = 0;
+    clock_gettime(CLOCK_MONOTONIC, &from);
+    if (engine == ENGINE_FCBO) {
+        computeConceptFromFast(&main_arena, obj, attr);
+    } else if (engine == ENGINE_SPARSE) {
+        computeConceptFromSparse(&main_arena, obj, attr);
+    } else if (engine == ENGINE_INCLOSE) {
+        computeConceptFromInClose(&main_arena, obj, attr);
+    } else {
+        computeConceptFromBits(&main_arena, obj, attr, 0);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &to);
+    // 2. compare count and digest
+    bool same = main_sink.concept_count == updated.concept_count && main_sink.digest == updated.digest;
+    printf("update   : %ld concepts, digest %016llx\n", updated.concept_count, (unsigned long long) updated.digest);
+    printf("full run : %ld concepts, digest %016llx, %f seconds\n\n", main_sink.concept_count,
+           (unsigned long long) main_sink.digest, elapsedSeconds(&from, &to));
+    printf("update check : %s\n", same ? "passed" : "FAILED");
+    main_sink.emit = emit;
+    main_sink.concept_count = output_count;
+    closeLattice(&lattice);
+    return same;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+// Implication basis
+//
+// The Duquenne-Guigues basis (stem base) by Ganter's NextClosure. Sets closed under the implications found so far are
+// visited in lectic order, every such set A is either an intent or a pseudo-intent, and a pseudo-intent adds the
+// implication A -> A''. The context closure A'' is one extent from the attribute columns and one intent from it.
+// Closures under the implications follow LinClosure: each implication counts the premise attributes still missing and
+// is fired when the count drops to zero, attributes are indexed to the implications whose premise holds them, and a
+// count is reset only when a closure first reaches its implication. The lectic test runs inside that closure, a new
+// attribute before the candidate one that is not in A ends it right away, so failing candidates cost only the
+// implications they fire.
+// ---------------------------------------------------------------------------------------------------------------------
+
+// enumerate the pseudo-intents of the context in lectic order and output the stem base
+void computeImplicationBasis(void) {
+    int i, w;
+    implications_t basis;
+    memset(&basis, 0, sizeof(basis));
+    basis.by_attribute = (long **) calloc(attribute_size, sizeof(long *));
+    basis.by_attribute_count = (long *) calloc(attribute_size, sizeof(long));
+    basis.by_attribute_capacity = (long *) calloc(attribute_size, sizeof(long));
+    basis.pending = (int *) malloc((attribute_size + 1) * sizeof(int));
+    uint64_t *set = (uint64_t *) calloc(attribute_words, sizeof(uint64_t)); // current closed set A
+    uint64_t *candidate = (uint64_t *) malloc(attribute_words * sizeof(uint64_t));
+    uint64_t *prefix = (uint64_t *) malloc(attribute_words * sizeof(uint64_t)); // A before the candidate attribute
+    uint64_t *extent = (uint64_t *) malloc(object_words * sizeof(uint64_t));
+    uint64_t *closure = (uint64_t *) malloc(attribute_words * sizeof(uint64_t));
+    uint64_t *all_objects = (uint64_t *) calloc(object_words, sizeof(uint64_t));
+    for (i = 0; i < data_size; i++) {
+        all_objects[BIT_WORD(i)] |= BIT_MASK(i);
+    }
+    FILE *file = (sink_kind == SINK_COUNT) ? NULL : writer.file; // opened as concept output, the writer stays idle
+    long intents = 0;
+    // the first set closed under no implication is the empty set
+    while (true) {
+        // 1. context closure, A'' from the objects having every attribute of A
+        memcpy(extent, all_objects, object_words * sizeof(uint64_t));
+        int size = 0;
+        for (w = 0; w < attribute_words; w++) {
+            uint64_t bits = set[w];
+            while (bits != 0) {
+                makeExtentBits(extent, extent, w * WORD_BITS + __builtin_ctzll(bits));
+                bits &= bits - 1;
+                size++;
+            }
+        }
+        makeIntentBits(closure, extent);
+        // 2. intent, or pseudo-intent adding A -> A''
+        if (memcmp(closure, set, attribute_words * sizeof(uint64_t)) == 0) {
+            intents++;
+        } else {
+            addImplication(&basis, set, closure);
+            writeImplication(file, set, closure, kernels.popcount(extent, object_words));
+        }
+        if (size == attribute_size) {
+            break; // all attributes, last set in lectic order
+        }
+        // 3. next set in lectic order closed under the implications
+        bool found = false;
+        for (i = attribute_size - 1; i >= 0 && !found; i--) {
+            if (checkAttributeBits(i, set)) {
+                continue;
+            }
+            for (w = 0; w < attribute_words; w++) {
+                prefix[w] = (w < BIT_WORD(i)) ? set[w] : (w == BIT_WORD(i)) ? set[w] & (BIT_MASK(i) - 1) : 0;
+            }
+            memcpy(candidate, prefix, attribute_words * sizeof(uint64_t));
+            candidate[BIT_WORD(i)] |= BIT_MASK(i);
+            if (closeUnderImplications(&basis, candidate, i, prefix)) {
+                memcpy(set, candidate, attribute_words * sizeof(uint64_t));
+                found = true;
+            }
+        }
+        if (!found) {
+            break;
+        }
+    }
+    concept_count = intents;
+    printf("\nTotal Implications : %ld\n", basis.count);
+    for (i = 0; i < attribute_size; i++) {
+        free(basis.by_attribute[i]);
+    }
+    free(basis.by_attribute);
+    free(basis.by_attribute_count);
+    free(basis.by_attribute_capacity);
+    free(basis.premises);
+    free(basis.conclusions);
+    free(basis.premise_sizes);
+    free(basis.missing);
+    free(basis.stamps);
+    free(basis.pending);
+    free(set);
+    free(candidate);
+    free(prefix);
+    free(extent);
+    free(closure);
+    free(all_objects);
+}
+
+/**
+ * close set under the implications (LinClosure), false as soon as it gains an attribute below limit outside prefix
+ *
+ * input :  1. implications
+ *          2. set, closed in place
+ *          3. candidate attribute of the lectic test
+ *          4. attributes of the current set below the candidate attribute
+ */
+bool closeUnderImplications(implications_t *basis, uint64_t *set, int limit, uint64_t *prefix) {
+    long k;
+    int w;
+    int pending = 0;
+    // 1. every premise attribute missing, counts are reset when first touched, empty premises fire at once
+    long stamp = ++basis->closures;
+    for (w = 0; w < attribute_words; w++) {
+        uint64_t bits = set[w];
+        while (bits != 0) {
+            basis->pending[pending++] = w * WORD_BITS + __builtin_ctzll(bits);
+            bits &= bits - 1;
+        }
+    }
+    for (k = 0; k < basis->count && basis->premise_sizes[k] == 0; k++) {
+        // only the first implication, from the empty set, can have an empty premise
+        if (!fireImplication(basis, k, set, limit, prefix, &pending)) {
+            return false;
+        }
+    }
+    // 2. each attribute of the set counts down the premises holding it
+    while (pending > 0) {
+        int a = basis->pending[--pending];
+        long *holding = basis->by_attribute[a];
+        long count = basis->by_attribute_count[a];
+        for (k = 0; k < count; k++) {
+            long h = holding[k];
+            if (basis->stamps[h] != stamp) {
+                basis->stamps[h] = stamp;
+                basis->missing[h] = basis->premise_sizes[h];
+            }
+            if (--basis->missing[h] == 0 && !fireImplication(basis, h, set, limit, prefix, &pending)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// add conclusion of implication k to set, false when it brings an attribute below limit outside prefix
+bool fireImplication(implications_t *basis, long k, uint64_t *set, int limit, uint64_t *prefix, int *pending) {
+    int w;
+    uint64_t *conclusion = &basis->conclusions[(size_t) k * attribute_words];
+    for (w = 0; w < attribute_words; w++) {
+        uint64_t added = conclusion[w] & ~set[w];
+        if (added == 0) {
+            continue;
+        }
+        // lectic test, attributes below limit have to be those of the prefix
+        uint64_t below = (w < BIT_WORD(limit)) ? ~0ULL : (w == BIT_WORD(limit)) ? BIT_MASK(limit) - 1 : 0;
+        if ((added & below & ~prefix[w]) != 0) {
+            return false;
+        }
+        set[w] |= added;
+        while (added != 0) {
+            basis->pending[(*pending)++] = w * WORD_BITS + __builtin_ctzll(added);
+            added &= added - 1;
+        }
+    }
+    return true;
+}
+
+// append implication premise -> conclusion and index it by its premise attributes
+void addImplication(implications_t *basis, uint64_t *premise, uint64_t *conclusion) {
+    int w;
+    if (basis->count == basis->capacity) {
+        basis->capacity = (basis->capacity == 0) ? 256 : 2 * basis->capacity;
+        basis->premises = (uint64_t *) realloc(basis->premises,
+                                               (size_t) basis->capacity * attribute_words * sizeof(uint64_t));
+        basis->conclusions = (uint64_t *) realloc(basis->conclusions,
+                                                  (size_t) basis->capacity * attribute_words * sizeof(uint64_t));
+        basis->premise_sizes = (int *) realloc(basis->premise_sizes, basis->capacity * sizeof(int));
+        basis->missing = (int *) realloc(basis->missing, basis->capacity * sizeof(int));
+        basis->stamps = (long *) realloc(basis->stamps, basis->capacity * sizeof(long));
+        if (basis->premises == NULL || basis->conclusions == NULL || basis->premise_sizes == NULL
+            || basis->missing == NULL || basis->stamps == NULL) {
+            fprintf(stderr, "Error allocating %ld implications\n", basis->capacity);
+            exit(EXIT_FAILURE);
+        }
+    }
+    long k = basis->count++;
+    memcpy(&basis->premises[(size_t) k * attribute_words], premise, attribute_words * sizeof(uint64_t));
+    memcpy(&basis->conclusions[(size_t) k * attribute_words], conclusion, attribute_words * sizeof(uint64_t));
+    basis->premise_sizes[k] = 0;
+    basis->stamps[k] = 0;
+    for (w = 0; w < attribute_words; w++) {
+        uint64_t bits = premise[w];
+        while (bits != 0) {
+            int a = w * WORD_BITS + __builtin_ctzll(bits);
+            if (basis->by_attribute_count[a] == basis->by_attribute_capacity[a]) {
+                basis->by_attribute_capacity[a] = (basis->by_attribute_capacity[a] == 0)
+                                                  ? 16 : 2 * basis->by_attribute_capacity[a];
+                basis->by_attribute[a] = (long *) realloc(basis->by_attribute[a],
+                                                          basis->by_attribute_capacity[a] * sizeof(long));
+            }
+            basis->by_attribute[a][basis->by_attribute_count[a]++] = k;
+            basis->premise_sizes[k]++;
+            bits &= bits - 1;
+        }
+    }
+}
+
+// write "<premise> -> <conclusion without premise> ; <support>" as attribute indices of the loaded context
+void writeImplication(FILE *file, uint64_t *premise, uint64_t *conclusion, long support) {
+    int w, s;
+    if (file == NULL) {
+        return;
+    }
+    int words = WORDS_FOR(output_attribute_size);
+    uint64_t mapped[2][words];
+    uint64_t *sets[2] = {premise, conclusion};
+    for (s = 0; s < 2; s++) {
+        if (preprocessed) {
+            // attributes only, objects are not merged without -p
+            uint64_t no_objects[object_words];
+            uint64_t mapped_objects[WORDS_FOR(output_data_size)];
+            memset(no_objects, 0, sizeof(no_objects));
+            mapConcept(no_objects, sets[s], mapped_objects, mapped[s]);
+        } else {
+            memcpy(mapped[s], sets[s], words * sizeof(uint64_t));
+        }
+    }
+    for (s = 0; s < 2; s++) {
+        bool first = true;
+        if (s == 1) {
+            fputs(" ->", file);
+        }
+        for (w = 0; w < words; w++) {
+            uint64_t bits = (s == 0) ? mapped[0][w] : mapped[1][w] & ~mapped[0][w];
+            while (bits != 0) {
+                fprintf(file, (first && s == 0) ? "%d" : " %d", w * WORD_BITS + __builtin_ctzll(bits));
+                first = false;
+                bits &= bits - 1;
+            }
+        }
+    }
+    fprintf(file, " ; %ld\n", support);
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+// Estimate
+//
+// Knuth's estimate of the size of a search tree, on the canonical Close-by-One tree of the bits engine. A path is
+// walked from the root, at every node all candidate attributes are closed and tested as the engine would, and one
+// canonical child is followed at random. A node reached through branching factors d1 .. dk stands for d1 * .. * dk
+// nodes of its depth, so the sum of these products over the path is an unbiased estimate of the concepts, and the
+// same sum weighting the candidates tried and the time taken at each node one of the work and of the runtime. Paths
+// are sampled until the time budget is spent. The estimates are heavy tailed on skewed trees: a rare deep path in a
+// wide branch carries most of the total, and until one is sampled the mean and its variance both come out too low.
+// The effective paths (sum squared over the sum of squares of the concept estimates) tell this apart, normal 95%
+// intervals from the sample variance are printed only when enough paths are effective, else a warning.
+// ---------------------------------------------------------------------------------------------------------------------
+
+// sample random root to leaf paths of the Close-by-One tree and print the estimated run, then exit
+void estimateConcepts(uint64_t *obj, uint64_t *attr) {
+    int j;
+    long samples = 0;
+    int deepest = 0;
+    double concepts_sum = 0, concepts_squares = 0; // per path estimates of the concepts
+    double candidates_sum = 0, candidates_squares = 0; // per path estimates of the candidates tried
+    double seconds_sum = 0, seconds_squares = 0; // per path estimates of the enumeration time
+    double depth_sum = 0; // per path estimates of the concepts weighted by depth
+    unsigned int seed = 1; // fixed, estimates are repeatable
+    uint64_t *extents[3], *intents[3]; // node on the path, candidate child, child picked so far
+    for (j = 0; j < 3; j++) {
+        extents[j] = (uint64_t *) malloc(object_words * sizeof(uint64_t));
+        intents[j] = (uint64_t *) malloc(attribute_words * sizeof(uint64_t));
+    }
+    struct timespec from, now, node_start, node_end;
+    clock_gettime(CLOCK_MONOTONIC, &from);
+    do {
+        // 1. walk one path, the root stands for itself only
+        memcpy(extents[0], obj, object_words * sizeof(uint64_t));
+        memcpy(intents[0], attr, attribute_words * sizeof(uint64_t));
+        double weight = 1;
+        double concepts = isFrequentBits(obj) ? 1 : 0;
+        double candidates = 0;
+        double seconds = 0;
+        double depths = 0;
+        int depth = 0;
+        int attr_index = 0;
+        while (concepts > 0) {
+            int children = 0;
+            int picked = -1;
+            long tried = 0;
+            // 2. every candidate of the node, one canonical child kept uniformly at random
+            clock_gettime(CLOCK_MONOTONIC, &node_start);
+            for (j = attr_index; j < attribute_size; j++) {
+                if (checkAttributeBits(j, intents[0])) {
+                    continue;
+                }
+                tried++;
+                makeExtentBits(extents[1], extents[0], j);
+                if (!isFrequentBits(extents[1]) || !closeAndTestBits(intents[1], extents[1], intents[0], j)) {
+                    continue;
+                }
+                children++;
+                if (rand_r(&seed) % children == 0) {
+                    uint64_t *swap = extents[1];
+                    extents[1] = extents[2];
+                    extents[2] = swap;
+                    swap = intents[1];
+                    intents[1] = intents[2];
+                    intents[2] = swap;
+                    picked = j;
+                }
+            }
+            clock_gettime(CLOCK_MONOTONIC, &node_end);
+            candidates += weight * tried;
+            seconds += weight * elapsedSeconds(&node_start, &node_end);
+            if (children == 0) {
+                break; // leaf
+            }
+            // 3. descend, the child stands for all nodes its siblings at this depth stand for
+            weight *= children;
+            depth++;
+            concepts += weight;
+            depths += weight * depth;
+            uint64_t *swap = extents[0];
+            extents[0] = extents[2];
+            extents[2] = swap;
+            swap = intents[0];
+            intents[0] = intents[2];
+            intents[2] = swap;
+            attr_index = picked + 1;
+        }
+        // 4. accumulate path estimates
+        samples++;
+        concepts_sum += concepts;
+        concepts_squares += concepts * concepts;
+        candidates_sum += candidates;
+        candidates_squares += candidates * candidates;
+        seconds_sum += seconds;
+        seconds_squares += seconds * seconds;
+        depth_sum += depths;
+        deepest = (depth > deepest) ? depth : deepest;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+    } while (elapsedSeconds(&from, &now) < estimate_budget);
+    // 5. intervals only when the estimates are not held by a few paths
+    double effective = (concepts_squares > 0) ? concepts_sum * concepts_sum / concepts_squares : 0;
+    bool enough = effective >= ESTIMATE_MIN_EFFECTIVE;
+    bool spread = effective >= ESTIMATE_MIN_SHARE * samples;
+    printf("estimate : %ld paths sampled in %f seconds, %.0f effective\n\n", samples, elapsedSeconds(&from, &now),
+           effective);
+    printInterval("concepts", concepts_sum, concepts_squares, samples, "", enough && spread);
+    printInterval("candidates", candidates_sum, candidates_squares, samples, "", enough && spread);
+    printInterval("runtime", seconds_sum, seconds_squares, samples, " seconds", enough && spread);
+    printf("depth : mean %.2f, deepest path sampled %d\n\n", concepts_sum > 0 ? depth_sum / concepts_sum : 0.0,
+           deepest);
+    if (!spread) {
+        printf("warning : %.0f of %ld paths effective, a few paths hold most of the estimate, the tree is skewed and "
+               "the run is likely larger, no interval given\n\n", effective, samples);
+    } else if (!enough) {
+        printf("warning : %.0f paths effective, too few for an interval, sample longer\n\n", effective);
+    }
+    for (j = 0; j < 3; j++) {
+        free(extents[j]);
+        free(intents[j]);
+    }
+    exit(EXIT_SUCCESS);
+}
+
+// print mean of per path estimates with its 95% interval, or its standard error when the interval is not reliable
+void printInterval(char *name, double sum, double squares, long samples, char *unit, bool reliable) {
+    double mean = sum / samples;
+    if (samples < 2) {
+        printf("%s : %.4g%s\n\n", name, mean, unit);
+        return;
+    }
+    double variance = (squares - sum * mean) / (samples - 1);
+    double error = sqrt(variance > 0 ? variance / samples : 0);
+    if (!reliable) {
+        printf("%s : %.4g%s (standard error %.4g)\n\n", name, mean, unit, error);
+        return;
+    }
+    printf("%s : %.4g%s (95%% interval %.4g - %.4g)\n\n", name, mean, unit,
+           mean - ESTIMATE_Z * error > 0 ? mean - ESTIMATE_Z * error : 0, mean + ESTIMATE_Z * error);
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+// Sparse engine
+//
+// Close-by-One on bitsets until an extent gets small, from there on the extent is a sorted list of object ids. A
+// child extent keeps the parent ids found in the packed column of the attribute, one probe per id, which beats
+// merging or galloping through sorted column lists. The closure tests the attributes of the first extent object
+// only, each against the other extent objects. Extents only shrink going down, so a branch that switched stays
+// sparse and its work scales with the extent instead of the object count.
+// ---------------------------------------------------------------------------------------------------------------------
+
+// build attribute id lists per object, and the extent size switching to object ids
+void packSparse(void) {
+    int i, a;
+    long ones = 0;
+    row_start = (int *) calloc(data_size + 1, sizeof(int));
+    // 1. count attributes of each object
+    for (i = 0; i < data_size; i++) {
+        int row = (int) kernels.popcount(&bit_rows[(size_t) i * attribute_words], attribute_words);
+        row_start[i + 1] = row_start[i] + row;
+        ones += row;
+    }
+    // 2. fill, bit order gives sorted attribute ids
+    row_attributes = (int *) malloc((ones + 1) * sizeof(int));
+    if (row_attributes == NULL) {
+        fprintf(stderr, "Error allocating object id lists\n");
+        exit(EXIT_FAILURE);
+    }
+    for (i = 0; i < data_size; i++) {
+        int *cursor = &row_attributes[row_start[i]];
+        for (a = 0; a < attribute_size; a++) {
+            if (bit_rows[(size_t) i * attribute_words + BIT_WORD(a)] & BIT_MASK(a)) {
+                *cursor++ = a;
+            }
+        }
+    }
+    // 3. a bitset test reads object_words words per attribute, a sparse closure probes the context density share of
+    // the attributes per extent object, tuned on the d5 datasets and mushroom
+    if (sparse_density >= 0) {
+        sparse_limit = (int) (sparse_density * data_size);
+    } else {
+        double context_density = (data_size > 0 && attribute_size > 0)
+                                 ? (double) ones / ((double) data_size * attribute_size) : 1;
+        double limit = (context_density > 0) ? object_words / (8 * context_density) : data_size;
+        sparse_limit = (int) (limit > WORD_BITS ? limit : WORD_BITS);
+    }
+    if (verbose) {
+        printf("sparse below %d objects\n\n", sparse_limit);
+    }
+}
+
+/**
+ * Close-by-One Algorithm switching to object id lists
+ *
+ * Runs on an explicit stack like computeConceptFromBits. A frame whose extent has fewer than sparse_limit objects
+ * also holds it as object ids and its children are computed from the id lists.
+ *
+ * input :  1. stack frames
+ *          2. object set
+ *          3. attribute set
+ */
+void computeConceptFromSparse(arena_t *arena, uint64_t *obj, uint64_t *attr) {
+    int depth = 0;
+    frame_t *frame = frameAt(arena, 0);
+    memcpy(frame->extent, obj, object_words * sizeof(uint64_t));
+    memcpy(frame->intent, attr, attribute_words * sizeof(uint64_t));
+    frame->attr_index = 0;
+    frame->sparse = false;
+    makeSparseFrame(frame);
+    // 1. Process Concept
+    STATS_DEPTH(0);
+    frame->id = ownsRoot(arena) ? processConceptBits(frame->extent, frame->intent, -1) : -1;
+    while (depth >= 0) {
+        frame = &arena->frames[depth];
+        // 2. go through remaining attributes of the concept on top of the stack
+        bool descended = false;
+        STATS_DEPTH(depth + 1);
+        while (frame->attr_index < attribute_size) {
+            int j = frame->attr_index++;
+            // 3. check current attribute exist or not, and root branch belongs to this shard
+            if (checkAttributeBits(j, frame->intent) || !ownsBranch(arena, depth, j)) {
+                continue;
+            }
+            // 4. make extent and intent fused with canonicity test in the next frame
+            frame_t *child = frameAt(arena, depth + 1);
+            bool canonical;
+            if (frame->sparse) {
+                makeExtentSparse(child, frame, j);
+                canonical = child->tid_count >= min_support // cut below minimum support before closing
+                            && closeAndTestSparse(child->intent, child->tids, child->tid_count, frame->intent, j);
+            } else {
+                if (child->sparse) {
+                    // drop the id list left by the previous occupant, the bitset is rewritten whole
+                    child->sparse = false;
+                }
+                makeExtentBits(child->extent, frame->extent, j);
+                canonical = isFrequentBits(child->extent)
+                            && closeAndTestBits(child->intent, child->extent, frame->intent, j);
+                if (canonical) {
+                    makeSparseFrame(child);
+                }
+            }
+            if (canonical) {
+                // 5. push child, process it and continue from its first attribute
+                child->attr_index = j + 1;
+                child->id = processConceptBits(child->extent, child->intent, frame->id);
+                depth++;
+                descended = true;
+                break;
+            }
+        }
+        if (!descended) {
+            depth--; // attributes exhausted, pop
+        }
+    }
+}
+
+// switch frame with a dense extent to object ids when the extent is small enough
+void makeSparseFrame(frame_t *frame) {
+    int w;
+    long size = kernels.popcount(frame->extent, object_words);
+    if (size >= sparse_limit) {
+        return;
+    }
+    int *cursor = frame->tids;
+    for (w = 0; w < object_words; w++) {
+        uint64_t bits = frame->extent[w];
+        while (bits != 0) {
+            *cursor++ = w * WORD_BITS + __builtin_ctzll(bits);
+            bits &= bits - 1;
+        }
+    }
+    frame->tid_count = (int) size;
+    frame->sparse = true;
+}
+
+// make extent of child as object ids of parent having attribute attr_index, and its bitset for the sinks
+void makeExtentSparse(frame_t *child, frame_t *parent, int attr_index) {
+    int i;
+    STATS_START(timer);
+    // 1. clear bits of the previous occupant, by its ids when it had them
+    if (child->sparse) {
+        for (i = 0; i < child->tid_count; i++) {
+            child->extent[BIT_WORD(child->tids[i])] &= ~BIT_MASK(child->tids[i]);
+        }
+    } else {
+        memset(child->extent, 0, object_words * sizeof(uint64_t));
+    }
+    // 2. keep parent objects found in the packed column, one probe per extent object
+    int *tids = parent->tids;
+    uint64_t *column = &bit_columns[(size_t) attr_index * object_words];
+    int count = 0;
+    for (i = 0; i < parent->tid_count; i++) {
+        child->tids[count] = tids[i];
+        count += (column[BIT_WORD(tids[i])] & BIT_MASK(tids[i])) != 0;
+    }
+    child->tid_count = count;
+    child->sparse = true;
+    for (i = 0; i < count; i++) {
+        child->extent[BIT_WORD(child->tids[i])] |= BIT_MASK(child->tids[i]);
+    }
+    STATS_STOP(timer, STAT_EXTENT);
+}
+
+/**
+ * make intent over the extent objects fused with canonicity test
+ *
+ * Common attributes of the extent are among the attributes of its first object, each one not in attr is probed in
+ * the columns of the other extent objects. Rows are sorted, so the attributes below attr_index come first and the
+ * first common one rejects the candidate.
+ *
+ * input :  1. intent to fill, complete only when true is returned
+ *          2. extent object ids
+ *          3. extent size
+ *          4. attribute set of the parent concept
+ *          5. current attribute index
+ */
+bool closeAndTestSparse(uint64_t *intent, int *tids, int tid_count, uint64_t *attr, int attr_index) {
+    int i, k;
+    bool canonical = true;
+    STATS_START(timer);
+    memcpy(intent, attr, attribute_words * sizeof(uint64_t));
+    if (tid_count == 0) {
+        // empty extent, every attribute is common
+        for (k = 0; k < attr_index && canonical; k++) {
+            canonical = checkAttributeBits(k, attr);
+        }
+        for (k = attr_index; k < attribute_size && canonical; k++) {
+            intent[BIT_WORD(k)] |= BIT_MASK(k);
+        }
+    } else {
+        // attributes of the first object, read only when there is one
+        for (k = row_start[tids[0]]; k < row_start[tids[0] + 1] && canonical; k++) {
+            int a = row_attributes[k];
+            if (checkAttributeBits(a, attr)) {
+                continue;
+            }
+            uint64_t *column = &bit_columns[(size_t) a * object_words];
+            for (i = 1; i < tid_count && (column[BIT_WORD(tids[i])] & BIT_MASK(tids[i])) != 0; i++) {
+            }
+            if (i == tid_count) {
+                // common to the extent, new below attr_index fails the test
+                canonical = a >= attr_index;
+                intent[BIT_WORD(a)] |= BIT_MASK(a);
+            }
+        }
+    }
+    STATS_STOP(timer, STAT_FUSED);
+    if (!canonical) {
+        STATS_FAILURE();
+    }
+    return canonical;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+// Bitset kernels
+//
+// Extents are intersected with attribute columns, tested against them for inclusion and counted. Each kernel has a
+// portable scalar version and AVX2 and AVX-512 versions compiled through target attributes, so the binary builds
+// without -m flags and runs anywhere. The widest variant the CPU supports is picked at startup.
+// ---------------------------------------------------------------------------------------------------------------------
+
+// kernel variants, narrowest first
+kernels_t kernel_variants[] = {
+        {"scalar", scalarSupported, intersectScalar, subsetScalar, popcountScalar},
+#if defined(__x86_64__) || defined(__i386__)
+        {"avx2",   avx2Supported,   intersectAvx2,   subsetAvx2,   popcountAvx2},
+        {"avx512", avx512Supported, intersectAvx512, subsetAvx512, popcountAvx512},
+#endif
+};
+
+// select kernel variant by name, auto picks the widest one supported
+void selectKernels(char *name) {
+    int v;
+    int variants = (int) (sizeof(kernel_variants) / sizeof(kernel_variants[0]));
+    bool automatic = strcmp(name, "auto") == 0;
+    for (v = variants - 1; v >= 0; v--) {
+        if (automatic ? kernel_variants[v].supported() : strcmp(name, kernel_variants[v].name) == 0) {
+            break;
+        }
+    }
+    if (v < 0) {
+        fprintf(stderr, "Error selecting kernels: %s: unknown variant\n", name);
+        exit(EXIT_FAILURE);
+    }
+    if (!kernel_variants[v].supported()) {
+        fprintf(stderr, "Error selecting kernels: %s: not supported by this CPU\n", name);
+        exit(EXIT_FAILURE);
+    }
+    kernels = kernel_variants[v];
+    if (verbose) {
+        printf("kernels : %s\n\n", kernels.name);
+    }
+}
+
+/**
+ * check padding bits of binary rows are refused, then enumerate concepts once per supported kernel variant and
+ * compare them, exits with failure on any difference
+ *
+ * input :  1. object set of the initial concept
+ *          2. attribute set of the initial concept
+ */
+void checkKernels(uint64_t *obj, uint64_t *attr) {
+    int v;
+    int variants = (int) (sizeof(kernel_variants) / sizeof(kernel_variants[0]));
+    long reference_count = -1;
+    uint64_t reference_digest = 0;
+    bool agree = true;
+    // 1. binary context rows with a bit past the last attribute are refused, clean ones kept
+    uint64_t rows[2] = {BIT_MASK(0) | BIT_MASK(40), BIT_MASK(2)}; // 2 objects, 3 attributes
+    bool refused = findPaddingRow(rows, 2, 3) == 0;
+    rows[0] = BIT_MASK(0);
+    bool kept = findPaddingRow(rows, 2, 3) < 0;
+    agree = refused && kept;
+    printf("%-8s : stray bit refused %s, clean rows kept %s\n", "loader", refused ? "yes" : "NO", kept ? "yes" : "NO");
+    for (v = 0; v < variants; v++) {
+        if (!kernel_variants[v].supported()) {
+            printf("%-8s : not supported\n", kernel_variants[v].name);
+            continue;
+        }
+        kernels = kernel_variants[v];
+        // 2. enumerate into a digest of the concept set
+        main_sink.emit = emitDigest;
+        main_sink.concept_count = 0;
+        main_sink.digest = 0;
+        clock_gettime(CLOCK_MONOTONIC, &wall_start);
+        if (!isFrequentBits(obj)) {
+            // no concept reaches the minimum support
+        } else if (engine == ENGINE_FCBO) {
+            computeConceptFromFast(&main_arena, obj, attr);
+        } else if (engine == ENGINE_SPARSE) {
+            computeConceptFromSparse(&main_arena, obj, attr);
+        } else if (engine == ENGINE_INCLOSE) {
+            computeConceptFromInClose(&main_arena, obj, attr);
+        } else {
+            computeConceptFromBits(&main_arena, obj, attr, 0);
+        }
+        clock_gettime(CLOCK_MONOTONIC, &wall_end);
+        // 3. compare with the first variant
+        if (reference_count < 0) {
+            reference_count = main_sink.concept_count;
+            reference_digest = main_sink.digest;
+        }
+        bool same = main_sink.concept_count == reference_count && main_sink.digest == reference_digest;
+        agree = agree && same;
+        printf("%-8s : %ld concepts, digest %016llx, %f seconds%s\n", kernels.name, main_sink.concept_count,
+               (unsigned long long) main_sink.digest, elapsedSeconds(&wall_start, &wall_end), same ? "" : ", MISMATCH");
+    }
+    printf("\nkernel check : %s\n", agree ? "passed" : "FAILED");
+    exit(agree ? EXIT_SUCCESS : EXIT_FAILURE);
+}
+
+// digest sink, sums a hash per concept so the digest does not depend on the enumeration order
+void emitDigest(sink_t *sink, uint64_t *extent, uint64_t *intent) {
+    int w;
+    uint64_t hash = 1469598103934665603ULL;
+    for (w = 0; w < WORDS_FOR(output_data_size); w++) {
+        hash = (hash ^ extent[w]) * 1099511628211ULL;
+        hash ^= hash >> 29;
+    }
+    for (w = 0; w < WORDS_FOR(output_attribute_size); w++) {
+        hash = (hash ^ intent[w]) * 1099511628211ULL;
+        hash ^= hash >> 29;
+    }
+    sink->digest += hash;
+    sink->concept_count++;
+}
+
+// scalar kernels run everywhere
+bool scalarSupported(void) {
+    return true;
+}
+
+void intersectScalar(uint64_t *result, uint64_t *a, uint64_t *b, int words) {
+    int w;
+    for (w = 0; w < words; w++) {
+        result[w] = a[w] & b[w];
+    }
+}
+
+bool subsetScalar(uint64_t *a, uint64_t *b, int words) {
+    int w;
+    // subset when no bit of a lies outside b
+    for (w = 0; w < words; w++) {
+        if ((a[w] & ~b[w]) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+long popcountScalar(uint64_t *a, int words) {
+    int w;
+    long count = 0;
+    for (w = 0; w < words; w++) {
+        count += __builtin_popcountll(a[w]);
+    }
+    return count;
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+// AVX2 kernels, four words per vector, scalar tail
+bool avx2Supported(void) {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("popcnt");
+}
+
+__attribute__((target("avx2")))
+void intersectAvx2(uint64_t *result, uint64_t *a, uint64_t *b, int words) {
+    int w;
+    for (w = 0; w + 4 <= words; w += 4) {
+        __m256i x = _mm256_loadu_si256((__m256i *) &a[w]);
+        __m256i y = _mm256_loadu_si256((__m256i *) &b[w]);
+        _mm256_storeu_si256((__m256i *) &result[w], _mm256_and_si256(x, y));
+    }
+    for (; w < words; w++) {
+        result[w] = a[w] & b[w];
+    }
+}
+
+__attribute__((target("avx2")))
+bool subsetAvx2(uint64_t *a, uint64_t *b, int words) {
+    int w;
+    for (w = 0; w + 4 <= words; w += 4) {
+        __m256i x = _mm256_loadu_si256((__m256i *) &a[w]);
+        __m256i y = _mm256_loadu_si256((__m256i *) &b[w]);
+        // testc sets carry when x AND NOT y is zero
+        if (!_mm256_testc_si256(y, x)) {
+            return false;
+        }
+    }
+    for (; w < words; w++) {
+        if ((a[w] & ~b[w]) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+__attribute__((target("avx2,popcnt")))
+long popcountAvx2(uint64_t *a, int words) {
+    int w;
+    long count = 0;
+    // hardware popcnt, four independent chains
+    long c0 = 0, c1 = 0, c2 = 0, c3 = 0;
+    for (w = 0; w + 4 <= words; w += 4) {
+        c0 += __builtin_popcountll(a[w]);
+        c1 += __builtin_popcountll(a[w + 1]);
+        c2 += __builtin_popcountll(a[w + 2]);
+        c3 += __builtin_popcountll(a[w + 3]);
+    }
+    for (; w < words; w++) {
+        count += __builtin_popcountll(a[w]);
+    }
+    return count + c0 + c1 + c2 + c3;
+}
+
+// AVX-512 kernels, eight words per vector, tail through a masked load
+bool avx512Supported(void) {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("popcnt");
+}
+
+__attribute__((target("avx512f")))
+void intersectAvx512(uint64_t *result, uint64_t *a, uint64_t *b, int words) {
+    int w;
+    for (w = 0; w + 8 <= words; w += 8) {
+        __m512i x = _mm512_loadu_si512((void *) &a[w]);
+        __m512i y = _mm512_loadu_si512((void *) &b[w]);
+        _mm512_storeu_si512((void *) &result[w], _mm512_and_si512(x, y));
+    }
+    if (w < words) {
+        __mmask8 tail = (__mmask8) ((1u << (words - w)) - 1);
+        __m512i x = _mm512_maskz_loadu_epi64(tail, &a[w]);
+        __m512i y = _mm512_maskz_loadu_epi64(tail, &b[w]);
+        _mm512_mask_storeu_epi64(&result[w], tail, _mm512_and_si512(x, y));
+    }
+}
+
+__attribute__((target("avx512f")))
+bool subsetAvx512(uint64_t *a, uint64_t *b, int words) {
+    int w;
+    for (w = 0; w + 8 <= words; w += 8) {
+        __m512i x = _mm512_loadu_si512((void *) &a[w]);
+        __m512i y = _mm512_loadu_si512((void *) &b[w]);
+        if (_mm512_test_epi64_mask(_mm512_andnot_si512(y, x), _mm512_andnot_si512(y, x)) != 0) {
+            return false;
+        }
+    }
+    if (w < words) {
+        __mmask8 tail = (__mmask8) ((1u << (words - w)) - 1);
+        __m512i x = _mm512_maskz_loadu_epi64(tail, &a[w]);
+        __m512i y = _mm512_maskz_loadu_epi64(tail, &b[w]);
+        if (_mm512_test_epi64_mask(_mm512_andnot_si512(y, x), _mm512_andnot_si512(y, x)) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+__attribute__((target("avx512f,popcnt")))
+long popcountAvx512(uint64_t *a, int words) {
+    // vector popcount needs AVX512-VPOPCNTDQ, missing on many AVX-512 parts, the popcnt chains keep up with the loads
+    return popcountAvx2(a, words);
+}
+#endif
+
+// ---------------------------------------------------------------------------------------------------------------------
+// Fast Close-by-One (FCbO)
+//
+// A closure failing the canonicity test at attribute j keeps the attribute below j that failed it as failing[j],
+// handed down to the children. A descendant with intent B skips j without any closure while that attribute is still
+// missing from B, the descendant closure would contain it too and fail again. The closure is fused with the test
+// and stops at the failing attribute, only canonical children are closed in full. Closures of a node are computed
+// first and its canonical children descended afterwards, so failures of every sibling reach all of them.
+// ---------------------------------------------------------------------------------------------------------------------
+
+/**
+ * Fast Close-by-One Algorithm
+ *
+ * Runs on an explicit stack like computeConceptFromBits. Frame d keeps the closures of its concept in per attribute
+ * slots, the queued children and the failed closures they inherit point into those slots.
+ *
+ * input :  1. stack frames
+ *          2. object set
+ *          3. attribute set
+ */
+void computeConceptFromFast(arena_t *arena, uint64_t *obj, uint64_t *attr) {
+    int depth = 0;
+    frame_t *frame = frameAt(arena, 0);
+    frame->extent = obj;
+    frame->intent = attr;
+    frame->attr_index = 0;
+    // 1. Process Concept
+    STATS_DEPTH(0);
+    frame->id = ownsRoot(arena) ? processConceptBits(frame->extent, frame->intent, -1) : -1;
+    // 2. compute closures of the concept, no failed tests yet
+    STATS_DEPTH(1);
+    expandConceptFast(frame, arena->no_failing);
+    while (depth >= 0) {
+        frame = &arena->frames[depth];
+        if (frame->next == frame->queued) {
+            depth--; // children exhausted, pop
+            continue;
+        }
+        // 3. push next queued child, its concept stays in the closure slot of this level
+        int j = frame->queue[frame->next++];
+        if (!ownsBranch(arena, depth, j)) {
+            continue; // root branch of another shard
+        }
+        frame_t *child = frameAt(arena, depth + 1);
+        child->extent = &frame->extents[(size_t) j * object_words];
+        child->intent = &frame->intents[(size_t) j * attribute_words];
+        child->attr_index = j + 1;
+        STATS_DEPTH(depth + 1);
+        child->id = processConceptBits(child->extent, child->intent, frame->id);
+        STATS_DEPTH(depth + 2);
+        expandConceptFast(child, frame->failing);
+        depth++;
+    }
+}
+
+/**
+ * compute closures of the frame concept, queueing canonical children and recording failing attributes
+ *
+ * input :  1. frame holding the concept
+ *          2. failing attribute per attribute inherited from the parent, -1 when none
+ */
+void expandConceptFast(frame_t *frame, int *failing) {
+    int j;
+    memcpy(frame->failing, failing, attribute_size * sizeof(int));
+    frame->queued = 0;
+    frame->next = 0;
+    // go through attribute list, closures first
+    for (j = frame->attr_index; j < attribute_size; j++) {
+        // check current attribute exist or not
+        if (checkAttributeBits(j, frame->intent)) {
+            continue;
+        }
+        // skip attribute already known to fail below this node
+        if (failing[j] >= 0 && !checkAttributeBits(failing[j], frame->intent)) {
+            STATS_COUNT(inherited_skips);
+            continue;
+        }
+        // make extent and intent in the slot of j
+        uint64_t *extent = &frame->extents[(size_t) j * object_words];
+        uint64_t *intent = &frame->intents[(size_t) j * attribute_words];
+        makeExtentBits(extent, frame->extent, j);
+        if (!isFrequentBits(extent)) {
+            continue; // below minimum support, descendants through j are too
+        }
+        // do canonicity test fused with the closure, queue child or remember the attribute failing it
+        int failed = closeOrFailingBits(intent, extent, frame->intent, j);
+        if (failed < 0) {
+            frame->queue[frame->queued++] = j;
+        } else {
+            frame->failing[j] = failed;
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+// Parallel mode (PCbO)
+//
+// Branches of the Close-by-One tree up to split_depth are spawned as tasks, deeper branches run serially inside the
+// task. Each worker owns a deque, pushing and popping its own tasks at the tail while idle workers steal from the
+// head of the other deques, swept from a random one. A worker finding nothing in any deque parks until a task is
+// pushed or the last one finishes. Every worker emits through its own sink, whole buffers reach the shared writer
+// and the concept counts are merged once all workers stop.
+// ---------------------------------------------------------------------------------------------------------------------
+
+// run Close-by-One from the initial concept on thread_count workers
+void computeConceptsParallel(uint64_t *obj, uint64_t *attr) {
+    int i;
+
+    workers = (worker_t *) calloc(thread_count, sizeof(worker_t));
+    for (i = 0; i < thread_count; i++) {
+        workers[i].id = i;
+        workers[i].seed = (unsigned int) i * 2654435761u + 1;
+        workers[i].deque.capacity = 64;
+        workers[i].deque.tasks = (task_t **) malloc(workers[i].deque.capacity * sizeof(task_t *));
+        pthread_mutex_init(&workers[i].deque.lock, NULL);
+        openSink(&workers[i].sink);
+        openArena(&workers[i].arena);
+    }
+
+    // seed first worker with the initial concept
+    current_worker = &workers[0];
+    spawnTask(obj, attr, 0, 0);
+    current_worker = NULL;
+
+    for (i = 0; i < thread_count; i++) {
+        pthread_create(&workers[i].thread, NULL, workerLoop, &workers[i]);
+    }
+    for (i = 0; i < thread_count; i++) {
+        pthread_join(workers[i].thread, NULL);
+    }
+
+    // merge per worker counts, flushing their last buffers
+    for (i = 0; i < thread_count; i++) {
+        closeSink(&workers[i].sink);
+        concept_count += workers[i].sink.concept_count;
+        closeArena(&workers[i].arena);
+        pthread_mutex_destroy(&workers[i].deque.lock);
+        free(workers[i].deque.tasks);
+    }
+    free(workers);
+    workers = NULL;
+}
+
+// worker thread, run own tasks then steal until no task is pending anywhere
+void *workerLoop(void *arg) {
+    worker_t *self = (worker_t *) arg;
+    current_worker = self;
+    while (atomic_load(&pending_tasks) > 0) {
+        task_t *task = findTask(self);
+        if (task == NULL) {
+            /*
+             * tasks still running elsewhere, sweep again under idle_lock and park until one is pushed or the last
+             * one finishes; a push the sweep misses sees idle_workers and signals once the wait released the lock
+             */
+            pthread_mutex_lock(&idle_lock);
+            atomic_fetch_add(&idle_workers, 1);
+            while (atomic_load(&pending_tasks) > 0 && (task = findTask(self)) == NULL) {
+                pthread_cond_wait(&idle_wake, &idle_lock);
+            }
+            atomic_fetch_sub(&idle_workers, 1);
+            pthread_mutex_unlock(&idle_lock);
+            if (task == NULL) {
+                continue; // every task finished
+            }
+        }
+        computeConceptFromParallel(task->extent, task->intent, task->attr_index, task->depth);
+        free(task);
+        if (atomic_fetch_sub(&pending_tasks, 1) == 1) {
+            // last task done, release every parked worker
+            pthread_mutex_lock(&idle_lock);
+            pthread_cond_broadcast(&idle_wake);
+            pthread_mutex_unlock(&idle_lock);
+        }
+    }
+    current_worker = NULL;
+    return NULL;
+}
+
+/**
+ * Close-by-One Algorithm, spawning children as tasks while depth is below split_depth
+ *
+ * input :  1. object set
+ *          2. attribute set
+ *          3. current attribute index
+ *          4. depth of the concept
+ */
+void computeConceptFromParallel(uint64_t *obj, uint64_t *attr, int attr_index, int depth) {
+    if (depth >= split_depth) {
+        STATS_BASE_DEPTH(depth);
+        current_worker->arena.sharded = (depth == 0 && shard_count > 1); // root run serially
+        computeConceptFromBits(&current_worker->arena, obj, attr, attr_index);
+        return;
+    }
+    STATS_BASE_DEPTH(0);
+    STATS_DEPTH(depth);
+    if (depth > 0 || shard_index == 0) {
+        processConceptBits(obj, attr, -1);
+    }
+    STATS_DEPTH(depth + 1);
+    int j;
+    for (j = attr_index; j < attribute_size; j++) {
+        if (!checkAttributeBits(j, attr) && (depth > 0 || shard_count == 1 || branch_shard[j] == shard_index)) {
+            uint64_t extent[object_words];
+            makeExtentBits(extent, obj, j);
+            uint64_t intent[attribute_words];
+            if (isFrequentBits(extent) && closeAndTestBits(intent, extent, attr, j)) {
+                spawnTask(extent, intent, (j + 1), (depth + 1));
+            }
+        }
+    }
+}
 
-// local functions
-void loadData(char *file_path);
+// copy concept into a new task on the deque of the calling worker
+void spawnTask(uint64_t *obj, uint64_t *attr, int attr_index, int depth) {
+    task_t *task = (task_t *) malloc(sizeof(task_t) + (object_words + attribute_words) * sizeof(uint64_t));
+    task->extent = (uint64_t *) (task + 1);
+    task->intent = task->extent + object_words;
+    memcpy(task->extent, obj, object_words * sizeof(uint64_t));
+    memcpy(task->intent, attr, attribute_words * sizeof(uint64_t));
+    task->attr_index = attr_index;
+    task->depth = depth;
+    atomic_fetch_add(&pending_tasks, 1); // count before publishing so the pool never looks drained
+    pushTask(&current_worker->deque, task);
+    if (atomic_load(&idle_workers) > 0) {
+        pthread_mutex_lock(&idle_lock);
+        pthread_cond_signal(&idle_wake); // one parked worker comes to steal it
+        pthread_mutex_unlock(&idle_lock);
+    }
+}
 
-void buildInitialConcept(char *obj, char *attr);
+// own most recent task, else the oldest task of the first other deque holding one, swept from a random deque
+task_t *findTask(worker_t *self) {
+    task_t *task = popTask(&self->deque);
+    int start = (int) (rand_r(&self->seed) % thread_count);
+    int v;
+    for (v = 0; task == NULL && v < thread_count; v++) {
+        int victim = (start + v) % thread_count;
+        if (victim != self->id) {
+            task = stealTask(&workers[victim].deque);
+        }
+    }
+    return task;
+}
 
-void computeConceptFrom(char *obj, char *attr, int attr_index);
+// push task on the tail, owner only
+void pushTask(deque_t *deque, task_t *task) {
+    pthread_mutex_lock(&deque->lock);
+    if (deque->tail == deque->capacity) {
+        if (deque->head > 0) {
+            // reclaim slots already stolen from the head
+            memmove(deque->tasks, deque->tasks + deque->head, (deque->tail - deque->head) * sizeof(task_t *));
+            deque->tail -= deque->head;
+            deque->head = 0;
+        }
+        if (deque->tail == deque->capacity) {
+            deque->capacity *= 2;
+            deque->tasks = (task_t **) realloc(deque->tasks, deque->capacity * sizeof(task_t *));
+        }
+    }
+    deque->tasks[deque->tail++] = task;
+    pthread_mutex_unlock(&deque->lock);
+}
 
-void processConcept(char *obj, char *attr);
+// pop most recent task from the tail, owner only
+task_t *popTask(deque_t *deque) {
+    task_t *task = NULL;
+    pthread_mutex_lock(&deque->lock);
+    if (deque->tail > deque->head) {
+        task = deque->tasks[--deque->tail];
+    }
+    if (deque->tail == deque->head) {
+        deque->head = deque->tail = 0;
+    }
+    pthread_mutex_unlock(&deque->lock);
+    return task;
+}
 
-bool checkAttribute(int j, char *attr);
+// steal oldest task from the head, other workers
+task_t *stealTask(deque_t *deque) {
+    task_t *task = NULL;
+    pthread_mutex_lock(&deque->lock);
+    if (deque->tail > deque->head) {
+        task = deque->tasks[deque->head++];
+    }
+    if (deque->tail == deque->head) {
+        deque->head = deque->tail = 0;
+    }
+    pthread_mutex_unlock(&deque->lock);
+    return task;
+}
 
-void makeExtent(char *extent, char *obj, int attr_index);
 
-void makeIntent(char *intent, char *extent, int attr_index);
+// ---------------------------------------------------------------------------------------------------------------------
+// Batched frontier engine
+//
+// Close-by-One with the extension step batched across concepts. Pending concepts sit on one stack, each round takes
+// concepts from its top until their candidate attributes fill a batch, and every candidate gets its extent, closure
+// and canonicity test in one data-parallel pass, split in chunks over a fixed team of threads. A second pass moves
+// the canonical children over their parents on the stack, where the next round takes them from. Stack and batch
+// buffers are allocated once and only grow, a round allocates nothing. The same batch structure would let an
+// accelerator evaluate a whole batch per launch instead of one extent per call.
+// ---------------------------------------------------------------------------------------------------------------------
 
-bool canonicity_test(char *attr, char *intent, int attr_index);
+// enumerate from the initial concept on thread_count threads, the calling thread included
+void computeConceptFromBatch(uint64_t *obj, uint64_t *attr) {
+    int i;
+    memset(&frontier, 0, sizeof(frontier));
+    frontier.candidate_capacity = (attribute_size > BATCH_CANDIDATES) ? attribute_size : BATCH_CANDIDATES;
+    frontier.candidate_node = (long *) malloc(frontier.candidate_capacity * sizeof(long));
+    frontier.candidate_attr = (int *) malloc(frontier.candidate_capacity * sizeof(int));
+    frontier.candidate_depth = (int *) malloc(frontier.candidate_capacity * sizeof(int));
+    frontier.child_slot = (long *) malloc(frontier.candidate_capacity * sizeof(long));
+    frontier.child_extents = (uint64_t *) malloc((size_t) frontier.candidate_capacity * object_words
+                                                 * sizeof(uint64_t));
+    frontier.child_intents = (uint64_t *) malloc((size_t) frontier.candidate_capacity * attribute_words
+                                                 * sizeof(uint64_t));
+    frontier.scratch_extents = (uint64_t *) malloc((size_t) thread_count * object_words * sizeof(uint64_t));
+    frontier.scratch_intents = (uint64_t *) malloc((size_t) thread_count * attribute_words * sizeof(uint64_t));
+    if (frontier.candidate_node == NULL || frontier.candidate_attr == NULL || frontier.candidate_depth == NULL
+        || frontier.child_slot == NULL || frontier.child_extents == NULL || frontier.child_intents == NULL
+        || frontier.scratch_extents == NULL || frontier.scratch_intents == NULL) {
+        fprintf(stderr, "Error allocating batch of %ld candidates\n", frontier.candidate_capacity);
+        exit(EXIT_FAILURE);
+    }
+    pthread_barrier_init(&frontier.start, NULL, thread_count);
+    pthread_barrier_init(&frontier.done, NULL, thread_count);
+    workers = (worker_t *) calloc(thread_count, sizeof(worker_t));
+    for (i = 0; i < thread_count; i++) {
+        workers[i].id = i;
+        openSink(&workers[i].sink);
+    }
 
-int main(int argc, char *argv[]) {
-    loadData(argv[1]); // read data from file path
+    // 1. root concept on the stack
+    current_worker = &workers[0];
+    reserveFrontier(1);
+    memcpy(frontier.extents, obj, object_words * sizeof(uint64_t));
+    memcpy(frontier.intents, attr, attribute_words * sizeof(uint64_t));
+    frontier.attr_index[0] = 0;
+    frontier.depth[0] = 0;
+    frontier.count = 1;
+    STATS_DEPTH(0);
+    if (shard_count == 1 || shard_index == 0) {
+        processConceptBits(obj, attr, -1);
+    }
+    for (i = 1; i < thread_count; i++) {
+        pthread_create(&workers[i].thread, NULL, batchLoop, &workers[i]);
+    }
 
-    char *ini_obj = (char *) malloc(data_size * sizeof(char)); // initial concept object list
-    char *ini_attr = (char *) malloc(attribute_size * sizeof(char)); // initial concept attribute list
-    buildInitialConcept(ini_obj, ini_attr); // make object and attribute list
+    while (frontier.count > 0) {
+        // 2. candidates of the concepts on top of the stack, as many as fit one batch
+        long candidates = 0;
+        long first = frontier.count;
+        while (first > 0) {
+            long node = first - 1;
+            uint64_t *intent = &frontier.intents[(size_t) node * attribute_words];
+            int depth = frontier.depth[node];
+            int j;
+            long needed = 0;
+            for (j = frontier.attr_index[node]; j < attribute_size; j++) {
+                needed += !checkAttributeBits(j, intent);
+            }
+            if (candidates + needed > frontier.candidate_capacity) {
+                break; // next round
+            }
+            for (j = frontier.attr_index[node]; j < attribute_size; j++) {
+                if (!checkAttributeBits(j, intent)
+                    && (depth > 0 || shard_count == 1 || branch_shard[j] == shard_index)) {
+                    frontier.candidate_node[candidates] = node;
+                    frontier.candidate_attr[candidates] = j;
+                    frontier.candidate_depth[candidates] = depth + 1;
+                    candidates++;
+                }
+            }
+            first = node;
+        }
+        frontier.candidates = candidates;
+        // 3. extents, closures and canonicity tests of the whole batch
+        runBatchPass(BATCH_EVALUATE);
+        // 4. canonical children replace the batch concepts on the stack, in candidate order
+        long children = 0;
+        long c;
+        for (c = 0; c < candidates; c++) {
+            frontier.child_slot[c] = (frontier.child_slot[c] < 0) ? -1 : first + children++;
+        }
+        reserveFrontier(first + children);
+        runBatchPass(BATCH_MOVE);
+        frontier.count = first + children;
+    }
 
-    start = clock(); // start timing
-    computeConceptFrom(ini_obj, ini_attr, 0); // invoke Close-by-One
-    end = clock(); // stop timing
+    frontier.stopping = true;
+    pthread_barrier_wait(&frontier.start);
+    for (i = 1; i < thread_count; i++) {
+        pthread_join(workers[i].thread, NULL);
+    }
+    current_worker = NULL;
 
-    printf("\nTotal Concepts : %d\n\n", concept_count);
-    printf("execution time : %f seconds\n\n", ((double) (end - start) / CLOCKS_PER_SEC));
+    // merge per thread counts, flushing their last buffers
+    for (i = 0; i < thread_count; i++) {
+        closeSink(&workers[i].sink);
+        concept_count += workers[i].sink.concept_count;
+    }
+    free(workers);
+    workers = NULL;
+    pthread_barrier_destroy(&frontier.start);
+    pthread_barrier_destroy(&frontier.done);
+    free(frontier.extents);
+    free(frontier.intents);
+    free(frontier.attr_index);
+    free(frontier.depth);
+    free(frontier.candidate_node);
+    free(frontier.candidate_attr);
+    free(frontier.candidate_depth);
+    free(frontier.child_slot);
+    free(frontier.child_extents);
+    free(frontier.child_intents);
+    free(frontier.scratch_extents);
+    free(frontier.scratch_intents);
+}
 
-    // Free Memory
-    free(cross_table);
-    free(ini_obj);
-    free(ini_attr);
+// team thread, joins every batch pass until the stack is empty
+void *batchLoop(void *arg) {
+    current_worker = (worker_t *) arg;
+    while (true) {
+        pthread_barrier_wait(&frontier.start);
+        if (frontier.stopping) {
+            break;
+        }
+        batchPass();
+        pthread_barrier_wait(&frontier.done);
+    }
+    current_worker = NULL;
+    return NULL;
+}
 
-    return 0;
+// run one pass over the batch on the whole team, returns once every thread is done
+void runBatchPass(batch_pass_t pass) {
+    frontier.pass = pass;
+    atomic_store(&frontier.next_candidate, 0);
+    pthread_barrier_wait(&frontier.start);
+    batchPass();
+    pthread_barrier_wait(&frontier.done);
 }
 
-// load data set file from given location
-void loadData(char *file_path) {
-    int err_num;
-    FILE *file;
-    if ((file = fopen(file_path, "rt")) == NULL) {
-        err_num = errno;
-        fprintf(stderr, "Value of errno: %d\n", errno);
-        perror("Error printed by perror");
-        fprintf(stderr, "Error opening file: %s\n", strerror(err_num));
-        exit(EXIT_FAILURE);
-    } else {
-        printf("\n~~~ Dataset Cross Table ~~~\n\n");
-
-        char *buffer = NULL;
-        size_t len = 0;
-        ssize_t read;
-        int line_count = 0;
-        int data_read_count = 0;
-        int obj_count = 0;
-        int atr_count = 0;
-        int x;
-        while ((read = getline(&buffer, &len, file)) != -1) {
-            // process lines
-            if (buffer[0] == '\n') {
-                // new line found
-            } else {
-                // skip first character on the .cxt file
-                if (line_count != 0) {
-                    if (line_count == 1) {
-                        // data size found
-                        data_size = atoi(buffer);
-                    } else if (line_count == 2) {
-                        // attribute size found
-                        attribute_size = atoi(buffer);
-                        cross_table = malloc(sizeof(char) * attribute_size * data_size); // allocate cross table
-                    } else if (line_count > 2 && line_count <= (data_size + 2)) {
-                        // read data set objects
-                        obj_count++;
-                    } else if (line_count > (2 + data_size) && line_count <= (2 + data_size + attribute_size)) {
-                        // read attributes
-                        atr_count++;
-                        obj_count = 0; // reset obj count
-                    } else if (line_count > (2 + data_size + attribute_size)) {
-                        // read cross table
-                        for (x = 0; x < attribute_size; x++) {
-                            // check attribute present or not
-                            if (buffer[x] == 'X') {
-                                cross_table[(obj_count * attribute_size) + x] = '1'; // assign one when 'X'
-                            } else {
-                                cross_table[(obj_count * attribute_size) + x] = '0'; // assign zero when '.'
-                            }
-                            printf("%c", cross_table[(obj_count * attribute_size) + x]);
-                        }
-                        printf("\n");
-                        obj_count++;
-                    }
+// work on chunks of the batch until none is left
+void batchPass(void) {
+    long c, end;
+    long candidates = frontier.candidates;
+    uint64_t *scratch_extent = &frontier.scratch_extents[(size_t) current_worker->id * object_words];
+    uint64_t *scratch_intent = &frontier.scratch_intents[(size_t) current_worker->id * attribute_words];
+    while ((c = atomic_fetch_add(&frontier.next_candidate, BATCH_CHUNK)) < candidates) {
+        end = (c + BATCH_CHUNK < candidates) ? c + BATCH_CHUNK : candidates;
+        for (; c < end; c++) {
+            uint64_t *child_extent = &frontier.child_extents[(size_t) c * object_words];
+            uint64_t *child_intent = &frontier.child_intents[(size_t) c * attribute_words];
+            long node = frontier.candidate_node[c];
+            int j = frontier.candidate_attr[c];
+            if (frontier.pass == BATCH_EVALUATE) {
+                // extent, closure and canonicity test in the scratch of the thread, canonical children are kept and
+                // output right away
+                uint64_t *extent = &frontier.extents[(size_t) node * object_words];
+                uint64_t *intent = &frontier.intents[(size_t) node * attribute_words];
+                STATS_DEPTH(frontier.candidate_depth[c]);
+                makeExtentBits(scratch_extent, extent, j);
+                bool canonical = isFrequentBits(scratch_extent)
+                                 && closeAndTestBits(scratch_intent, scratch_extent, intent, j);
+                frontier.child_slot[c] = canonical ? 0 : -1;
+                if (canonical) {
+                    memcpy(child_extent, scratch_extent, object_words * sizeof(uint64_t));
+                    memcpy(child_intent, scratch_intent, attribute_words * sizeof(uint64_t));
+                    processConceptBits(child_extent, child_intent, -1);
                 }
-                line_count++;
+            } else if (frontier.child_slot[c] >= 0) {
+                // move the child to its stack slot, parents of the batch are not read any more
+                long slot = frontier.child_slot[c];
+                memcpy(&frontier.extents[(size_t) slot * object_words], child_extent, object_words * sizeof(uint64_t));
+                memcpy(&frontier.intents[(size_t) slot * attribute_words], child_intent,
+                       attribute_words * sizeof(uint64_t));
+                frontier.attr_index[slot] = j + 1;
+                frontier.depth[slot] = frontier.candidate_depth[c];
             }
         }
-        fclose(file);
-        free(buffer);
-        printf("\n");
     }
 }
 
-// build up initial concept
-// out: objects, attributes
-void buildInitialConcept(char *obj, char *attr) {
-    int i;
-    int a;
-    /**
-     * assign objects
-     * pass all objects into list, according to the theorem, (X)
-     */
-    for (i = 0; i < data_size; i++) {
-        obj[i] = '1';
+// make room for count concepts on the stack, growing by doubling
+void reserveFrontier(long count) {
+    if (count <= frontier.capacity) {
+        return;
     }
+    while (frontier.capacity < count) {
+        frontier.capacity = (frontier.capacity == 0) ? 1024 : 2 * frontier.capacity;
+    }
+    frontier.extents = (uint64_t *) realloc(frontier.extents,
+                                            (size_t) frontier.capacity * object_words * sizeof(uint64_t));
+    frontier.intents = (uint64_t *) realloc(frontier.intents,
+                                            (size_t) frontier.capacity * attribute_words * sizeof(uint64_t));
+    frontier.attr_index = (int *) realloc(frontier.attr_index, frontier.capacity * sizeof(int));
+    frontier.depth = (int *) realloc(frontier.depth, frontier.capacity * sizeof(int));
+    if (frontier.extents == NULL || frontier.intents == NULL || frontier.attr_index == NULL || frontier.depth == NULL) {
+        fprintf(stderr, "Error allocating frontier of %ld concepts\n", frontier.capacity);
+        exit(EXIT_FAILURE);
+    }
+}
 
-    /**
-     * assign attributes
-     * set common attribute list for all objects on cross table (X up)
-     */
-    // go through attributes
-    for (a = 0; a < attribute_size; a++) {
-        bool status = true;
-        // go through objects
-        for (i = 0; i < data_size; i++) {
-            if (cross_table[(i * attribute_size) + a] == '0') {
-                status = false;
-                break;
-            }
+// ---------------------------------------------------------------------------------------------------------------------
+// Concept output sinks
+//
+// Every thread emits through its own sink. The text and binary sinks encode concepts into a buffer and hand full
+// buffers to one background writer thread, so enumeration only waits for I/O when every buffer is in flight.
+// Buffers hold whole records, output of different threads interleaves by buffer, never inside a concept.
+// ---------------------------------------------------------------------------------------------------------------------
+
+// open concept output and start the writer thread for buffered sinks
+void openOutput(void) {
+    int i;
+    if (sink_kind == SINK_COUNT) {
+        return;
+    }
+    writer.file = stdout;
+    if (resuming) {
+        // keep the concepts output before the checkpoint, drop anything written after it
+        struct stat written;
+        off_t offset = (off_t) resume_header.output_offset;
+        if ((writer.file = fopen(output_path, "r+b")) == NULL || fstat(fileno(writer.file), &written) != 0) {
+            int err_num = errno;
+            fprintf(stderr, "Error opening file: %s: %s\n", output_path, strerror(err_num));
+            exit(EXIT_FAILURE);
         }
-        if (status) {
-            // attribute available for all objects, assign 1
-            attr[a] = '1';
-        } else {
-            attr[a] = '0';
+        if (written.st_size < offset) {
+            fprintf(stderr, "Error resuming: %s: shorter than its checkpoint\n", output_path);
+            exit(EXIT_FAILURE);
+        }
+        if (ftruncate(fileno(writer.file), offset) != 0 || fseeko(writer.file, offset, SEEK_SET) != 0) {
+            int err_num = errno;
+            fprintf(stderr, "Error writing file: %s: %s\n", output_path, strerror(err_num));
+            exit(EXIT_FAILURE);
+        }
+    } else if (output_path != NULL && (writer.file = fopen(output_path, "wb")) == NULL) {
+        int err_num = errno;
+        fprintf(stderr, "Error opening file: %s: %s\n", output_path, strerror(err_num));
+        exit(EXIT_FAILURE);
+    }
+    if (sink_kind == SINK_BINARY && !resuming) {
+        concept_stream_header_t header;
+        memset(&header, 0, sizeof(header));
+        memcpy(header.magic, CONCEPT_STREAM_MAGIC, sizeof(header.magic));
+        header.version = CONCEPT_STREAM_VERSION;
+        header.objects = output_data_size;
+        header.attributes = output_attribute_size;
+        fwrite(&header, sizeof(header), 1, writer.file);
+    }
+    // one buffer filling per sink, the rest queued or being written
+    int buffers = 2 * thread_count + 2;
+    size_t capacity = maxRecordSize() > OUTPUT_BUFFER_SIZE ? maxRecordSize() : OUTPUT_BUFFER_SIZE;
+    for (i = 0; i < buffers; i++) {
+        output_buffer_t *buffer = (output_buffer_t *) malloc(sizeof(output_buffer_t) + capacity);
+        if (buffer == NULL) {
+            fprintf(stderr, "Error allocating output buffers\n");
+            exit(EXIT_FAILURE);
         }
+        buffer->data = (char *) (buffer + 1);
+        buffer->used = 0;
+        buffer->next = writer.free_list;
+        writer.free_list = buffer;
     }
+    pthread_mutex_init(&writer.lock, NULL);
+    pthread_cond_init(&writer.queued, NULL);
+    pthread_cond_init(&writer.released, NULL);
+    pthread_create(&writer.thread, NULL, writerLoop, NULL);
 }
 
-/**
- * Close-by-One Algorithm
- *
- * input :  1. object list
- *          2. attribute list
- *          3. current attribute index
- */
-void computeConceptFrom(char *obj, char *attr, int attr_index) {
-    // 1. Process Concept
-    processConcept(obj, attr);
-    // 2. go through attribute list
-    int j;
-    for (j = attr_index; j < attribute_size; j++) {
-        // 3. check current attribute exist or not
-        if (!checkAttribute(j, attr)) {
-            // 4. make extent
-            char extent[data_size];
-            makeExtent(extent, obj, j);
-            // 5. make intent
-            char intent[attribute_size];
-            makeIntent(intent, extent, j);
-            // 6. do canonicity test
-            if (canonicity_test(attr, intent, j)) {
-                // 7. call computeConceptFrom
-                computeConceptFrom(extent, intent, (j + 1));
+// stop the writer once every queued buffer is written and close concept output
+void closeOutput(void) {
+    if (sink_kind == SINK_COUNT) {
+        return;
+    }
+    pthread_mutex_lock(&writer.lock);
+    writer.stopping = true;
+    pthread_cond_signal(&writer.queued);
+    pthread_mutex_unlock(&writer.lock);
+    pthread_join(writer.thread, NULL);
+    while (writer.free_list != NULL) {
+        output_buffer_t *next = writer.free_list->next;
+        free(writer.free_list);
+        writer.free_list = next;
+    }
+    pthread_cond_destroy(&writer.released);
+    pthread_cond_destroy(&writer.queued);
+    pthread_mutex_destroy(&writer.lock);
+    if (writer.file != stdout) {
+        fclose(writer.file);
+    } else {
+        fflush(stdout);
+    }
+}
+
+// hand the buffer of the main sink to the writer and wait until all output is on disk, returns output bytes
+off_t drainOutput(void) {
+    if (sink_kind == SINK_COUNT) {
+        return 0;
+    }
+    if (main_sink.buffer != NULL) {
+        submitBuffer(main_sink.buffer);
+        main_sink.buffer = NULL;
+    }
+    pthread_mutex_lock(&writer.lock);
+    while (writer.head != NULL || writer.writing) {
+        pthread_cond_wait(&writer.released, &writer.lock);
+    }
+    pthread_mutex_unlock(&writer.lock);
+    if (fflush(writer.file) != 0 || fsync(fileno(writer.file)) != 0) {
+        perror("Error writing concepts");
+        exit(EXIT_FAILURE);
+    }
+    return ftello(writer.file);
+}
+
+// prepare sink of the selected kind
+void openSink(sink_t *sink) {
+    sink->concept_count = 0;
+    sink->buffer = NULL;
+    sink->mapped_extent = NULL;
+    sink->mapped_intent = NULL;
+    if (preprocessed) {
+        sink->mapped_extent = (uint64_t *) malloc(WORDS_FOR(output_data_size) * sizeof(uint64_t));
+        sink->mapped_intent = (uint64_t *) malloc(WORDS_FOR(output_attribute_size) * sizeof(uint64_t));
+    }
+    if (sink_kind == SINK_TEXT) {
+        sink->emit = emitText;
+    } else if (sink_kind == SINK_BINARY) {
+        sink->emit = emitBinary;
+    } else {
+        sink->emit = emitCount;
+    }
+}
+
+// hand the last partial buffer of the sink to the writer
+void closeSink(sink_t *sink) {
+    if (sink->buffer != NULL) {
+        submitBuffer(sink->buffer);
+        sink->buffer = NULL;
+    }
+    free(sink->mapped_extent);
+    free(sink->mapped_intent);
+    sink->mapped_extent = NULL;
+    sink->mapped_intent = NULL;
+}
+
+// output concept through the sink of the calling thread
+void emitConcept(uint64_t *extent, uint64_t *intent) {
+    STATS_CONCEPT(extent);
+    sink_t *sink = (current_worker != NULL) ? &current_worker->sink : &main_sink;
+    if (preprocessed) {
+        // back to objects and attributes of the loaded context
+        mapConcept(extent, intent, sink->mapped_extent, sink->mapped_intent);
+        extent = sink->mapped_extent;
+        intent = sink->mapped_intent;
+    }
+    sink->emit(sink, extent, intent);
+}
+
+// count sink
+void emitCount(sink_t *sink, uint64_t *extent, uint64_t *intent) {
+    sink->concept_count++;
+}
+
+// text sink, "<objects> | <attributes>" as space separated indices
+void emitText(sink_t *sink, uint64_t *extent, uint64_t *intent) {
+    int w;
+    reserveOutput(sink, maxRecordSize());
+    char *cursor = sink->buffer->data + sink->buffer->used;
+    char digits[12];
+    uint64_t *sets[2] = {extent, intent};
+    int words[2] = {WORDS_FOR(output_data_size), WORDS_FOR(output_attribute_size)};
+    int s;
+    for (s = 0; s < 2; s++) {
+        bool first = true;
+        if (s == 1) {
+            *cursor++ = ' ';
+            *cursor++ = '|';
+        }
+        for (w = 0; w < words[s]; w++) {
+            uint64_t bits = sets[s][w];
+            while (bits != 0) {
+                unsigned int index = (unsigned int) (w * WORD_BITS + __builtin_ctzll(bits));
+                int n = 0;
+                do {
+                    digits[n++] = (char) ('0' + index % 10);
+                    index /= 10;
+                } while (index != 0);
+                if (!first || s == 1) {
+                    *cursor++ = ' ';
+                }
+                while (n > 0) {
+                    *cursor++ = digits[--n];
+                }
+                first = false;
+                bits &= bits - 1;
             }
         }
     }
+    *cursor++ = '\n';
+    sink->buffer->used = cursor - sink->buffer->data;
+    sink->concept_count++;
 }
 
-// store concept
-void processConcept(char *obj, char *attr) {
-//    printf("\n-------------------------------\n");
-    printf("Concept - %d\n\n", concept_count);
-/*    int i;
-    // set objects details on concept lattice
-    concept_lattice[concept_count].objects = malloc(sizeof(char) * data_size);
-    printf("Object Set : ");
-    strncpy(concept_lattice[concept_count].objects, obj, data_size);
-    printf("%s ", concept_lattice[concept_count].objects);
-    for (i = 0; i < data_size; i++) {
-        concept_lattice[concept_count].objects[i] = obj[i];
-        printf("%c ", obj[i]);
-    }*/
-    printf("\n");
+// binary sink, extent size, intent size and indices as 32-bit words
+void emitBinary(sink_t *sink, uint64_t *extent, uint64_t *intent) {
+    int w;
+    reserveOutput(sink, maxRecordSize());
+    uint32_t *record = (uint32_t *) (sink->buffer->data + sink->buffer->used);
+    uint32_t *cursor = record + 2;
+    uint32_t *sizes = record;
+    for (w = 0; w < WORDS_FOR(output_data_size); w++) {
+        uint64_t bits = extent[w];
+        while (bits != 0) {
+            *cursor++ = (uint32_t) (w * WORD_BITS + __builtin_ctzll(bits));
+            bits &= bits - 1;
+        }
+    }
+    sizes[0] = (uint32_t) (cursor - record - 2);
+    for (w = 0; w < WORDS_FOR(output_attribute_size); w++) {
+        uint64_t bits = intent[w];
+        while (bits != 0) {
+            *cursor++ = (uint32_t) (w * WORD_BITS + __builtin_ctzll(bits));
+            bits &= bits - 1;
+        }
+    }
+    sizes[1] = (uint32_t) (cursor - record - 2 - sizes[0]);
+    sink->buffer->used = (char *) cursor - sink->buffer->data;
+    sink->concept_count++;
+}
 
-    // set attribute details on concept latice
-/*    concept_lattice[concept_count].attributes = (char *) malloc(sizeof(char) * attribute_size);
-    printf("Attribute Set : ");
-    strncpy(concept_lattice[concept_count].attributes, obj, attribute_size);
-    for (i = 0; i < attribute_size; i++) {
-        concept_latice[concept_count].attributes[i] = attr[i];
-        printf("%c ", attr[i]);
+// largest encoded concept of the selected sink in bytes
+size_t maxRecordSize(void) {
+    if (sink_kind == SINK_BINARY) {
+        return ((size_t) output_data_size + output_attribute_size + 2) * sizeof(uint32_t);
     }
-    printf("\n-------------------------------\n\n");*/
-    concept_count++;
+    return ((size_t) output_data_size + output_attribute_size) * 11 + 4; // up to 10 digits and a separator per index
 }
 
-// check attribute contains on attribute list or not
-bool checkAttribute(int j, char *attr) {
-    bool status = true;
-    if (attr[j] == '0') {
-        status = false;
+// make room for size bytes in the sink buffer, handing a full buffer to the writer
+void reserveOutput(sink_t *sink, size_t size) {
+    size_t capacity = maxRecordSize() > OUTPUT_BUFFER_SIZE ? maxRecordSize() : OUTPUT_BUFFER_SIZE;
+    if (sink->buffer != NULL && capacity - sink->buffer->used < size) {
+        submitBuffer(sink->buffer);
+        sink->buffer = NULL;
+    }
+    if (sink->buffer == NULL) {
+        sink->buffer = acquireBuffer();
     }
-    return status;
 }
 
-// make extent
-void makeExtent(char *extent, char *obj, int attr_index) {
-    int i, z;
-//    printf("extent (attr : %d): ", attr_index);
-    // go through cross table
-    for (i = 0; i < data_size; i++) {
-        extent[i] = '0'; // set default value
-        if (cross_table[(i * attribute_size) + attr_index] == '1' && obj[i] != '0') {
-            extent[i] = '1'; // set object index to extent list
+// take an empty buffer, waiting for the writer when all are in flight
+output_buffer_t *acquireBuffer(void) {
+    pthread_mutex_lock(&writer.lock);
+    while (writer.free_list == NULL) {
+        pthread_cond_wait(&writer.released, &writer.lock);
+    }
+    output_buffer_t *buffer = writer.free_list;
+    writer.free_list = buffer->next;
+    pthread_mutex_unlock(&writer.lock);
+    buffer->used = 0;
+    buffer->next = NULL;
+    return buffer;
+}
+
+// queue a filled buffer for the writer
+void submitBuffer(output_buffer_t *buffer) {
+    pthread_mutex_lock(&writer.lock);
+    buffer->next = NULL;
+    if (writer.tail == NULL) {
+        writer.head = buffer;
+    } else {
+        writer.tail->next = buffer;
+    }
+    writer.tail = buffer;
+    pthread_cond_signal(&writer.queued);
+    pthread_mutex_unlock(&writer.lock);
+}
+
+// writer thread, write queued buffers in order until stopped and drained
+void *writerLoop(void *arg) {
+    pthread_mutex_lock(&writer.lock);
+    while (true) {
+        while (writer.head == NULL && !writer.stopping) {
+            pthread_cond_wait(&writer.queued, &writer.lock);
         }
-//        printf("%c ", extent[i]);
+        if (writer.head == NULL) {
+            break; // stopping and drained
+        }
+        output_buffer_t *buffer = writer.head;
+        writer.head = buffer->next;
+        if (writer.head == NULL) {
+            writer.tail = NULL;
+        }
+        writer.writing = true;
+        pthread_mutex_unlock(&writer.lock);
+        if (fwrite(buffer->data, 1, buffer->used, writer.file) != buffer->used) {
+            perror("Error writing concepts");
+            exit(EXIT_FAILURE);
+        }
+        pthread_mutex_lock(&writer.lock);
+        buffer->next = writer.free_list;
+        writer.free_list = buffer;
+        writer.writing = false;
+        pthread_cond_signal(&writer.released);
     }
-//    printf("\n");
+    pthread_mutex_unlock(&writer.lock);
+    return NULL;
 }
 
-// make intent
-void makeIntent(char *intent, char *extent, int attr_index) {
-    int i, a;
-    int empty_count = 0;
-//    printf("intent (attr : %d): ", attr_index);
-    // check extent is empty set
-    for (i = 0; i < data_size; i++) {
-        if (extent[i] == '0') {
-            empty_count++;
+// ---------------------------------------------------------------------------------------------------------------------
+// Lattice store
+//
+// Concepts are appended to packed arenas growing by doubling, one allocation per array instead of two per concept,
+// with their parent in the Close-by-One tree. Covers are found from each concept with Lindig's neighbor search: the
+// closures of the intent plus one attribute are the candidates, a candidate whose new attributes include one still
+// minimal is not a neighbor and knocks out its generator. Closures are looked up by intent in a hash table, so no
+// pair of concepts is ever compared. Lower covers are stored in CSR form, upper covers are their transpose.
+// ---------------------------------------------------------------------------------------------------------------------
+
+// prepare empty lattice store
+void openLattice(lattice_t *store) {
+    memset(store, 0, sizeof(lattice_t));
+}
+
+// release lattice store
+void closeLattice(lattice_t *store) {
+    free(store->extents);
+    free(store->intents);
+    free(store->parents);
+    free(store->lower_start);
+    free(store->lower);
+    free(store->upper_start);
+    free(store->upper);
+    memset(store, 0, sizeof(lattice_t));
+}
+
+// append concept with its Close-by-One parent, returns its id
+long storeConcept(lattice_t *store, uint64_t *extent, uint64_t *intent, long parent) {
+    if (store->count == store->capacity) {
+        // grow every arena by doubling
+        store->capacity = (store->capacity == 0) ? 1024 : 2 * store->capacity;
+        store->extents = (uint64_t *) realloc(store->extents, (size_t) store->capacity * object_words * sizeof(uint64_t));
+        store->intents = (uint64_t *) realloc(store->intents,
+                                              (size_t) store->capacity * attribute_words * sizeof(uint64_t));
+        store->parents = (long *) realloc(store->parents, store->capacity * sizeof(long));
+        if (store->extents == NULL || store->intents == NULL || store->parents == NULL) {
+            fprintf(stderr, "Error allocating lattice store of %ld concepts\n", store->capacity);
+            exit(EXIT_FAILURE);
         }
     }
-    for (a = 0; a < attribute_size; a++) {
-        // validate on empty extent set
-        if (empty_count != data_size) {
-            bool status = true;
-            for (i = 0; i < data_size; i++) {
-                // check extent available
-                if (extent[i] != '0') {
-                    // check related cross table index of current extent attribute availability
-                    if (cross_table[(i * attribute_size) + a] != '1') {
-                        status = false;
-                        break;
+    long id = store->count++;
+    memcpy(&store->extents[(size_t) id * object_words], extent, object_words * sizeof(uint64_t));
+    memcpy(&store->intents[(size_t) id * attribute_words], intent, attribute_words * sizeof(uint64_t));
+    store->parents[id] = parent;
+    return id;
+}
+
+/**
+ * compute lower and upper covers of every stored concept
+ *
+ * For concept (A, B) and each attribute m not in B in ascending order, D = (B + m)'' is a lower neighbor unless
+ * D - B - m holds an attribute still in the minimal set, in which case m leaves the minimal set (Lindig 2000).
+ * Attributes of a neighbor found already give the same closure and only leave the minimal set.
+ *
+ * input :  1. lattice store
+ */
+void buildCovers(lattice_t *store) {
+    long c, k;
+    int a, w;
+    // 1. intent hash table
+    struct timespec from, to;
+    clock_gettime(CLOCK_MONOTONIC, &from);
+    long table_size = 0;
+    long *table = growTable(store, NULL, &table_size);
+    // 2. lower neighbors of every concept, appended in concept order
+    long capacity = store->count + 1;
+    store->lower_start = (long *) malloc((store->count + 1) * sizeof(long));
+    store->lower = (long *) malloc(capacity * sizeof(long));
+    uint64_t *minimal = (uint64_t *) malloc(attribute_words * sizeof(uint64_t));
+    uint64_t *covered = (uint64_t *) malloc(attribute_words * sizeof(uint64_t)); // attributes of neighbors found
+    uint64_t *extent = (uint64_t *) malloc(object_words * sizeof(uint64_t));
+    uint64_t *intent = (uint64_t *) malloc(attribute_words * sizeof(uint64_t));
+    store->edges = 0;
+    for (c = 0; c < store->count; c++) {
+        uint64_t *concept_extent = &store->extents[(size_t) c * object_words];
+        uint64_t *concept_intent = &store->intents[(size_t) c * attribute_words];
+        store->lower_start[c] = store->edges;
+        memset(covered, 0, attribute_words * sizeof(uint64_t));
+        for (w = 0; w < attribute_words; w++) {
+            minimal[w] = ~concept_intent[w];
+        }
+        if (attribute_size % WORD_BITS != 0) {
+            minimal[attribute_words - 1] &= BIT_MASK(attribute_size) - 1;
+        }
+        for (a = 0; a < attribute_size; a++) {
+            if (checkAttributeBits(a, concept_intent)) {
+                continue;
+            }
+            if (checkAttributeBits(a, covered)) {
+                // closure is a neighbor found already, which holds a minimal generator too
+                minimal[BIT_WORD(a)] &= ~BIT_MASK(a);
+                continue;
+            }
+            // 3. the closure is no neighbor when it adds another minimal attribute, tested first as most fail
+            makeExtentBits(extent, concept_extent, a);
+            bool neighbor = true;
+            for (w = 0; w < attribute_words && neighbor; w++) {
+                uint64_t candidates = minimal[w];
+                if (w == BIT_WORD(a)) {
+                    candidates &= ~BIT_MASK(a);
+                }
+                while (candidates != 0 && neighbor) {
+                    neighbor = !isExtentInColumnBits(extent, w * WORD_BITS + __builtin_ctzll(candidates));
+                    candidates &= candidates - 1;
+                }
+            }
+            if (!neighbor) {
+                minimal[BIT_WORD(a)] &= ~BIT_MASK(a);
+                continue;
+            }
+            // finish the intent from the attributes no longer minimal
+            memcpy(intent, concept_intent, attribute_words * sizeof(uint64_t));
+            intent[BIT_WORD(a)] |= BIT_MASK(a);
+            for (w = 0; w < attribute_words; w++) {
+                uint64_t candidates = ~(concept_intent[w] | minimal[w]);
+                if (w == attribute_words - 1 && attribute_size % WORD_BITS != 0) {
+                    candidates &= BIT_MASK(attribute_size) - 1;
+                }
+                while (candidates != 0) {
+                    int b = w * WORD_BITS + __builtin_ctzll(candidates);
+                    if (isExtentInColumnBits(extent, b)) {
+                        intent[w] |= BIT_MASK(b);
                     }
+                    candidates &= candidates - 1;
                 }
             }
-            if (status) {
-                intent[a] = '1';
-            } else {
-                intent[a] = '0';
+            for (w = 0; w < attribute_words; w++) {
+                covered[w] |= intent[w];
             }
-        } else {
-            intent[a] = '1';
+            if (!isFrequentBits(extent)) {
+                continue; // below minimum support, not stored
+            }
+            // 4. record neighbor by id
+            if (store->edges == capacity) {
+                capacity *= 2;
+                store->lower = (long *) realloc(store->lower, capacity * sizeof(long));
+                if (store->lower == NULL) {
+                    fprintf(stderr, "Error allocating %ld cover edges\n", capacity);
+                    exit(EXIT_FAILURE);
+                }
+            }
+            long neighbor_id = findConcept(store, table, table_size, intent);
+            if (neighbor_id < 0) {
+                fprintf(stderr, "Error building covers: closure missing from the lattice store\n");
+                exit(EXIT_FAILURE);
+            }
+            store->lower[store->edges++] = neighbor_id;
         }
-//        printf("%c ", intent[a]);
     }
-//    printf("\n");
+    store->lower_start[store->count] = store->edges;
+    // 5. upper covers by transposing, counting sort on the lower concept
+    store->upper_start = (long *) calloc(store->count + 1, sizeof(long));
+    store->upper = (long *) malloc((store->edges + 1) * sizeof(long));
+    for (k = 0; k < store->edges; k++) {
+        store->upper_start[store->lower[k] + 1]++;
+    }
+    for (c = 0; c < store->count; c++) {
+        store->upper_start[c + 1] += store->upper_start[c];
+    }
+    long *fill = (long *) malloc((store->count + 1) * sizeof(long));
+    memcpy(fill, store->upper_start, (store->count + 1) * sizeof(long));
+    for (c = 0; c < store->count; c++) {
+        for (k = store->lower_start[c]; k < store->lower_start[c + 1]; k++) {
+            store->upper[fill[store->lower[k]]++] = c;
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &to);
+    printf("lattice : %ld concepts, %ld cover edges in %f seconds\n\n", store->count, store->edges,
+           elapsedSeconds(&from, &to));
+    free(fill);
+    free(minimal);
+    free(covered);
+    free(extent);
+    free(intent);
+    free(table);
 }
 
-// perform canonicity test
-bool canonicity_test(char *attr, char *intent, int attr_index) {
-    bool status = false;
-    char set_1[attr_index];
-    char set_2[attr_index];
-    int set_1_c = 0;// holds set 1 found count
-    int set_2_c = 0;// holds set 2 found count
-    int i;
-    // 1. check on atribute list
-    for (i = 0; i < attr_index; i++) {
-        // check attr set
-        if (attr[i] == '1') {
-            set_1_c++;
-            set_1[i] = '1';
-        } else {
-            set_1[i] = '0';
+// id of the stored concept with given intent, -1 when not stored
+long findConcept(lattice_t *store, long *table, long table_size, uint64_t *intent) {
+    long slot = (long) (hashBits(intent, attribute_words) & (table_size - 1));
+    while (table[slot] != -1) {
+        if (memcmp(&store->intents[(size_t) table[slot] * attribute_words], intent,
+                   attribute_words * sizeof(uint64_t)) == 0) {
+            return table[slot];
         }
+        slot = (slot + 1) & (table_size - 1);
+    }
+    return -1;
+}
 
-        // check intent set
-        if (intent[i] == '1') {
-            set_2_c++;
-            set_2[i] = '1';
-        } else {
-            set_2[i] = '0';
+// hash of a bitset
+uint64_t hashBits(uint64_t *set, int words) {
+    int w;
+    uint64_t hash = 1469598103934665603ULL;
+    for (w = 0; w < words; w++) {
+        hash = (hash ^ set[w]) * 1099511628211ULL;
+        hash ^= hash >> 29;
+    }
+    return hash;
+}
+
+// write lattice file, concepts mapped back to the loaded context, parents and covers as 64-bit ids
+void writeLattice(lattice_t *store, char *file_path) {
+    long c, k;
+    FILE *file = fopen(file_path, "wb");
+    if (file == NULL) {
+        int err_num = errno;
+        fprintf(stderr, "Error opening file: %s: %s\n", file_path, strerror(err_num));
+        exit(EXIT_FAILURE);
+    }
+    lattice_header_t header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, LATTICE_MAGIC, sizeof(header.magic));
+    header.version = LATTICE_VERSION;
+    header.objects = output_data_size;
+    header.attributes = output_attribute_size;
+    header.concepts = store->count;
+    header.edges = store->edges;
+    fwrite(&header, sizeof(header), 1, file);
+    for (c = 0; c < store->count; c++) {
+        int64_t parent = store->parents[c];
+        fwrite(&parent, sizeof(parent), 1, file);
+    }
+    // extents then intents, mapped when preprocessed
+    int out_words[2] = {WORDS_FOR(output_data_size), WORDS_FOR(output_attribute_size)};
+    uint64_t *mapped[2] = {
+            (uint64_t *) malloc(out_words[0] * sizeof(uint64_t)), (uint64_t *) malloc(out_words[1] * sizeof(uint64_t))
+    };
+    int part;
+    for (part = 0; part < 2; part++) {
+        for (c = 0; c < store->count; c++) {
+            uint64_t *extent = &store->extents[(size_t) c * object_words];
+            uint64_t *intent = &store->intents[(size_t) c * attribute_words];
+            if (preprocessed) {
+                mapConcept(extent, intent, mapped[0], mapped[1]);
+                extent = mapped[0];
+                intent = mapped[1];
+            }
+            fwrite(part == 0 ? extent : intent, sizeof(uint64_t), out_words[part], file);
+        }
+    }
+    free(mapped[0]);
+    free(mapped[1]);
+    // cover relation, lower then upper
+    long *csr[4] = {store->lower_start, store->lower, store->upper_start, store->upper};
+    long lengths[4] = {store->count + 1, store->edges, store->count + 1, store->edges};
+    for (part = 0; part < 4; part++) {
+        for (k = 0; k < lengths[part]; k++) {
+            int64_t value = csr[part][k];
+            fwrite(&value, sizeof(value), 1, file);
         }
     }
+    if (fclose(file) != 0) {
+        int err_num = errno;
+        fprintf(stderr, "Error writing file: %s: %s\n", file_path, strerror(err_num));
+        exit(EXIT_FAILURE);
+    }
+}
 
-    if (set_1_c == 0 && set_2_c == 0) {
-        // both are empty set
-        status = true;
-    } else if ((set_1_c != 0 && set_2_c == 0) || (set_1_c == 0 && set_2_c != 0)) {
-        // found some element(s) on either of set
-        status = false;
-    } else if (set_1_c == set_2_c) {
-        // found element(s) on both sets
-        for (i = 0; i < attr_index; i++) {
-            if (set_1[i] != set_2[i]) {
-                status = false;
-                break;
-            } else {
-                status = true;
+#ifdef CBO_STATS
+// ---------------------------------------------------------------------------------------------------------------------
+// Instrumentation, built with -DCBO_STATS only
+//
+// Each thread counts calls and cycles of the closure functions, canonicity failures and concepts by depth of the
+// Close-by-One tree in its own stats_t. Counters of all threads are summed and printed after the run.
+// ---------------------------------------------------------------------------------------------------------------------
+
+// time stamp counter, monotonic nanoseconds where not available
+uint64_t readCycles(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t) now.tv_sec * 1000000000ULL + now.tv_nsec;
+#endif
+}
+
+// counters of the calling thread, registered on first use
+stats_t *threadStats(void) {
+    if (thread_stats == NULL) {
+        size_t depths = attribute_size + 2;
+        thread_stats = (stats_t *) calloc(1, sizeof(stats_t));
+        thread_stats->depth_concepts = (uint64_t *) calloc(depths, sizeof(uint64_t));
+        thread_stats->depth_closures = (uint64_t *) calloc(depths, sizeof(uint64_t));
+        thread_stats->depth_failures = (uint64_t *) calloc(depths, sizeof(uint64_t));
+        thread_stats->depth_extent_objects = (uint64_t *) calloc(depths, sizeof(uint64_t));
+        pthread_mutex_lock(&stats_lock);
+        thread_stats->next = all_stats;
+        all_stats = thread_stats;
+        pthread_mutex_unlock(&stats_lock);
+    }
+    return thread_stats;
+}
+
+// count one call of an instrumented function, closures by depth
+void recordCall(stat_kind_t kind, uint64_t cycles) {
+    stats_t *stats = threadStats();
+    stats->calls[kind]++;
+    stats->cycles[kind] += cycles;
+    if (kind == STAT_INTENT || kind == STAT_FUSED) {
+        stats->depth_closures[stats_depth]++;
+    }
+}
+
+// count one candidate rejected by the canonicity test
+void recordFailure(void) {
+    stats_t *stats = threadStats();
+    stats->canonicity_failures++;
+    stats->depth_failures[stats_depth]++;
+}
+
+// count one concept and its extent size
+void recordConcept(uint64_t *extent) {
+    uint64_t objects = (uint64_t) kernels.popcount(extent, object_words);
+    stats_t *stats = threadStats();
+    stats->concepts++;
+    stats->extent_objects += objects;
+    stats->depth_concepts[stats_depth]++;
+    stats->depth_extent_objects[stats_depth] += objects;
+}
+
+// print counters summed over all threads, and write them as JSON when requested
+void dumpStats(void) {
+    static const char *names[STAT_KINDS] = {"makeExtent", "makeIntent", "canonicity_test", "closeAndTest"};
+    stats_t total;
+    stats_t *stats;
+    int depths = attribute_size + 2;
+    int kind, d;
+    int max_depth = 0;
+    memset(&total, 0, sizeof(total));
+    total.depth_concepts = (uint64_t *) calloc(depths, sizeof(uint64_t));
+    total.depth_closures = (uint64_t *) calloc(depths, sizeof(uint64_t));
+    total.depth_failures = (uint64_t *) calloc(depths, sizeof(uint64_t));
+    total.depth_extent_objects = (uint64_t *) calloc(depths, sizeof(uint64_t));
+    for (stats = all_stats; stats != NULL; stats = stats->next) {
+        for (kind = 0; kind < STAT_KINDS; kind++) {
+            total.calls[kind] += stats->calls[kind];
+            total.cycles[kind] += stats->cycles[kind];
+        }
+        total.canonicity_failures += stats->canonicity_failures;
+        total.inherited_skips += stats->inherited_skips;
+        total.concepts += stats->concepts;
+        total.extent_objects += stats->extent_objects;
+        for (d = 0; d < depths; d++) {
+            total.depth_concepts[d] += stats->depth_concepts[d];
+            total.depth_closures[d] += stats->depth_closures[d];
+            total.depth_failures[d] += stats->depth_failures[d];
+            total.depth_extent_objects[d] += stats->depth_extent_objects[d];
+            if (stats->depth_concepts[d] != 0 || stats->depth_closures[d] != 0) {
+                max_depth = d > max_depth ? d : max_depth;
             }
         }
     }
+    uint64_t tests = total.calls[STAT_CANONICITY] + total.calls[STAT_FUSED];
 
-    return status;
-}
\ No newline at end of file
+    printf("~~~ Instrumentation ~~~\n\n");
+    for (kind = 0; kind < STAT_KINDS; kind++) {
+        printf("%-16s calls %14llu  cycles %16llu  cycles/call %10.1f\n", names[kind],
+               (unsigned long long) total.calls[kind], (unsigned long long) total.cycles[kind],
+               total.calls[kind] ? (double) total.cycles[kind] / total.calls[kind] : 0.0);
+    }
+    printf("canonicity       tests %14llu  failures %14llu  (%.1f %%)\n", (unsigned long long) tests,
+           (unsigned long long) total.canonicity_failures, tests ? total.canonicity_failures * 100.0 / tests : 0.0);
+    printf("inherited skips  %llu\n", (unsigned long long) total.inherited_skips);
+    printf("concepts         %llu  average extent size %.2f\n\n", (unsigned long long) total.concepts,
+           total.concepts ? (double) total.extent_objects / total.concepts : 0.0);
+    printf("%6s %14s %14s %14s %14s\n", "depth", "concepts", "closures", "failures", "avg extent");
+    for (d = 0; d <= max_depth; d++) {
+        printf("%6d %14llu %14llu %14llu %14.2f\n", d, (unsigned long long) total.depth_concepts[d],
+               (unsigned long long) total.depth_closures[d], (unsigned long long) total.depth_failures[d],
+               total.depth_concepts[d] ? (double) total.depth_extent_objects[d] / total.depth_concepts[d] : 0.0);
+    }
+    printf("\n");
+
+    if (stats_path != NULL) {
+        FILE *file = fopen(stats_path, "w");
+        if (file == NULL) {
+            int err_num = errno;
+            fprintf(stderr, "Error writing file: %s: %s\n", stats_path, strerror(err_num));
+        } else {
+            fprintf(file, "{\n  \"functions\": {\n");
+            for (kind = 0; kind < STAT_KINDS; kind++) {
+                fprintf(file, "    \"%s\": {\"calls\": %llu, \"cycles\": %llu}%s\n", names[kind],
+                        (unsigned long long) total.calls[kind], (unsigned long long) total.cycles[kind],
+                        kind + 1 < STAT_KINDS ? "," : "");
+            }
+            fprintf(file, "  },\n  \"canonicity_tests\": %llu,\n  \"canonicity_failures\": %llu,\n"
+                          "  \"inherited_skips\": %llu,\n  \"concepts\": %llu,\n  \"extent_objects\": %llu,\n"
+                          "  \"depths\": [\n", (unsigned long long) tests,
+                    (unsigned long long) total.canonicity_failures, (unsigned long long) total.inherited_skips,
+                    (unsigned long long) total.concepts, (unsigned long long) total.extent_objects);
+            for (d = 0; d <= max_depth; d++) {
+                fprintf(file, "    {\"depth\": %d, \"concepts\": %llu, \"closures\": %llu, \"failures\": %llu, "
+                              "\"extent_objects\": %llu}%s\n", d, (unsigned long long) total.depth_concepts[d],
+                        (unsigned long long) total.depth_closures[d], (unsigned long long) total.depth_failures[d],
+                        (unsigned long long) total.depth_extent_objects[d], d < max_depth ? "," : "");
+            }
+            fprintf(file, "  ]\n}\n");
+            fclose(file);
+        }
+    }
+    free(total.depth_concepts);
+    free(total.depth_closures);
+    free(total.depth_failures);
+    free(total.depth_extent_objects);
+}
+#endif
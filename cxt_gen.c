@@ -0,0 +1,300 @@
+// -----------------------------------------
+//
+// Synthetic context generator
+//
+// Writes random formal contexts of the nNmMdDsS family of dataset/ (N attributes, M objects, D percent density,
+// seed S) as Burmeister .cxt or as binary context (CBOC) read by cbo_v2 and libcbo. Rows are generated and written
+// one object at a time, memory does not grow with the object count, so contexts of millions of objects can be made
+// for scaling studies. Besides independent cells, objects can be drawn from clusters sharing a core of attributes,
+// and neighbouring attributes of a row can be correlated.
+//
+// -----------------------------------------
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <errno.h>
+#include <unistd.h>
+
+#define WORD_BITS 64 // bits held by one packed bitset word
+#define WORDS_FOR(n) (((n) + WORD_BITS - 1) / WORD_BITS) // words needed to hold n bits
+#define BIT_WORD(i) ((i) / WORD_BITS) // word holding bit i
+#define BIT_MASK(i) (1ULL << ((i) % WORD_BITS)) // mask of bit i inside its word
+
+#define BINARY_CONTEXT_MAGIC "CBOC" // leading bytes of a binary context file
+#define BINARY_CONTEXT_VERSION 1 // binary context layout version
+#define CLUSTER_HIT 0.8 // probability an object of a cluster has an attribute of the cluster core
+#define CORE_SHARE 0.5 // share of the expected attributes of an object taken from its cluster core
+#define WRITE_BUFFER_SIZE (1 << 20) // bytes of stdio buffer of the output
+
+// define binary_context_header_t for hold binary context header, followed by object rows of packed attribute words
+typedef struct {
+    char magic[4];
+    uint32_t version;
+    uint32_t objects;
+    uint32_t attributes;
+} binary_context_header_t;
+
+long object_count = 0; // holds objects (rows) to generate
+int attribute_count = 0; // holds attributes (columns) to generate
+double density = 5; // holds expected percentage of crosses
+uint64_t seed = 1000; // holds seed of the generator, same seed and options give the same context
+int cluster_count = 0; // holds clusters objects are drawn from, 0 for independent cells
+double correlation = 0; // holds probability an attribute repeats the one before it in the row
+bool binary = false; // holds output format, binary context or .cxt
+char *output_path = NULL; // holds output location, named after the parameters when NULL, "-" for stdout
+uint64_t state; // holds generator state
+uint64_t *cores = NULL; // holds core attribute set of every cluster
+uint64_t core_threshold; // holds threshold of a core attribute being set
+uint64_t noise_threshold; // holds threshold of any other attribute being set
+
+// local functions
+void usage(char *program);
+
+void prepareClusters(void);
+
+void generateRow(uint64_t *row);
+
+uint64_t nextRandom(void);
+
+uint64_t threshold(double probability);
+
+void writeCxtHeader(FILE *file);
+
+void writeCxtRow(FILE *file, uint64_t *row, char *line);
+
+void writeBinaryHeader(FILE *file);
+
+int main(int argc, char *argv[]) {
+    int opt;
+    while ((opt = getopt(argc, argv, "n:m:d:s:k:r:bo:")) != -1) {
+        switch (opt) {
+            case 'n':
+                attribute_count = atoi(optarg);
+                break;
+            case 'm':
+                object_count = atol(optarg);
+                break;
+            case 'd':
+                density = atof(optarg);
+                break;
+            case 's':
+                seed = strtoull(optarg, NULL, 10);
+                break;
+            case 'k':
+                cluster_count = atoi(optarg);
+                break;
+            case 'r':
+                correlation = atof(optarg);
+                break;
+            case 'b':
+                binary = true;
+                break;
+            case 'o':
+                output_path = optarg;
+                break;
+            default:
+                usage(argv[0]);
+        }
+    }
+    if (attribute_count <= 0 || object_count <= 0 || object_count > INT32_MAX || density < 0 || density > 100
+        || cluster_count < 0 || correlation < 0 || correlation > 1) {
+        usage(argv[0]);
+    }
+
+    // 1. output, named after the parameters unless given
+    char default_path[128];
+    if (output_path == NULL) {
+        int length = snprintf(default_path, sizeof(default_path), "n%dm%ldd%gs%llu", attribute_count, object_count,
+                              density, (unsigned long long) seed);
+        if (cluster_count > 0) {
+            length += snprintf(default_path + length, sizeof(default_path) - length, "k%d", cluster_count);
+        }
+        if (correlation > 0) {
+            length += snprintf(default_path + length, sizeof(default_path) - length, "r%g", correlation);
+        }
+        snprintf(default_path + length, sizeof(default_path) - length, binary ? ".cboc" : ".cxt");
+        output_path = default_path;
+    }
+    bool to_stdout = strcmp(output_path, "-") == 0;
+    FILE *file = to_stdout ? stdout : fopen(output_path, "wb");
+    if (file == NULL) {
+        int err_num = errno;
+        fprintf(stderr, "Error opening file: %s: %s\n", output_path, strerror(err_num));
+        exit(EXIT_FAILURE);
+    }
+    setvbuf(file, NULL, _IOFBF, WRITE_BUFFER_SIZE);
+
+    // 2. generator state, cluster cores, then rows one at a time
+    state = seed;
+    prepareClusters();
+    int words = WORDS_FOR(attribute_count);
+    uint64_t *row = (uint64_t *) malloc(words * sizeof(uint64_t));
+    char *line = (char *) malloc(attribute_count + 1);
+    if (row == NULL || line == NULL) {
+        fprintf(stderr, "Error allocating row of %d attributes\n", attribute_count);
+        exit(EXIT_FAILURE);
+    }
+    if (binary) {
+        writeBinaryHeader(file);
+    } else {
+        writeCxtHeader(file);
+    }
+    long i;
+    long crosses = 0;
+    for (i = 0; i < object_count; i++) {
+        generateRow(row);
+        int w;
+        for (w = 0; w < words; w++) {
+            crosses += __builtin_popcountll(row[w]);
+        }
+        if (binary) {
+            fwrite(row, sizeof(uint64_t), words, file);
+        } else {
+            writeCxtRow(file, row, line);
+        }
+    }
+    if (ferror(file) || (to_stdout ? fflush(file) : fclose(file)) != 0) {
+        int err_num = errno;
+        fprintf(stderr, "Error writing file: %s: %s\n", output_path, strerror(err_num));
+        exit(EXIT_FAILURE);
+    }
+    fprintf(stderr, "%s : %ld objects, %d attributes, density %.4f%%\n", output_path, object_count, attribute_count,
+            100.0 * crosses / ((double) object_count * attribute_count));
+
+    free(row);
+    free(line);
+    free(cores);
+    return 0;
+}
+
+// print command line usage and exit
+void usage(char *program) {
+    fprintf(stderr, "usage: %s -n attributes -m objects [-d density] [-s seed] [-k clusters] [-r correlation] [-b]\n"
+                    "          [-o output]\n", program);
+    fprintf(stderr, "  -n  attributes\n");
+    fprintf(stderr, "  -m  objects\n");
+    fprintf(stderr, "  -d  percentage of crosses (default: 5)\n");
+    fprintf(stderr, "  -s  seed (default: 1000)\n");
+    fprintf(stderr, "  -k  clusters, objects of a cluster share most of a core of attributes (default: 0, none)\n");
+    fprintf(stderr, "  -r  probability an attribute repeats the one before it in the row (default: 0)\n");
+    fprintf(stderr, "  -b  binary context (CBOC) instead of .cxt\n");
+    fprintf(stderr, "  -o  output file, \"-\" for stdout (default: n<N>m<M>d<D>s<S>[k<K>][r<R>].cxt or .cboc)\n");
+    exit(EXIT_FAILURE);
+}
+
+/**
+ * draw the core attributes of every cluster and the cell probabilities
+ *
+ * Without clusters every cell is set with the density. With clusters, CORE_SHARE of the expected attributes of an
+ * object come from its cluster core, each held with probability CLUSTER_HIT, the rest are noise spread over the
+ * other attributes, so the expected density stays the one asked for.
+ */
+void prepareClusters(void) {
+    int c, a;
+    double p = density / 100;
+    if (cluster_count == 0) {
+        noise_threshold = threshold(p);
+        return;
+    }
+    int words = WORDS_FOR(attribute_count);
+    int core_size = (int) (CORE_SHARE * p * attribute_count / CLUSTER_HIT + 0.5);
+    if (core_size > attribute_count) {
+        core_size = attribute_count;
+    }
+    double core_crosses = core_size * CLUSTER_HIT;
+    double rest = (attribute_count > core_size) ? (p * attribute_count - core_crosses) / (attribute_count - core_size)
+                                                : 0;
+    core_threshold = threshold(CLUSTER_HIT);
+    noise_threshold = threshold(rest > 0 ? rest : 0);
+    cores = (uint64_t *) calloc((size_t) cluster_count * words, sizeof(uint64_t));
+    if (cores == NULL) {
+        fprintf(stderr, "Error allocating %d cluster cores\n", cluster_count);
+        exit(EXIT_FAILURE);
+    }
+    for (c = 0; c < cluster_count; c++) {
+        // core_size distinct attributes, by selection sampling
+        uint64_t *core = &cores[(size_t) c * words];
+        int needed = core_size;
+        for (a = 0; a < attribute_count && needed > 0; a++) {
+            if (nextRandom() % (uint64_t) (attribute_count - a) < (uint64_t) needed) {
+                core[BIT_WORD(a)] |= BIT_MASK(a);
+                needed--;
+            }
+        }
+    }
+}
+
+// draw one object row, cluster first, then every attribute left to right
+void generateRow(uint64_t *row) {
+    int a;
+    int words = WORDS_FOR(attribute_count);
+    uint64_t *core = (cluster_count > 0) ? &cores[(nextRandom() % cluster_count) * words] : NULL;
+    uint64_t repeat = threshold(correlation);
+    bool previous = false;
+    memset(row, 0, words * sizeof(uint64_t));
+    for (a = 0; a < attribute_count; a++) {
+        bool set;
+        if (a > 0 && correlation > 0 && nextRandom() < repeat) {
+            set = previous; // same as the attribute before
+        } else {
+            bool in_core = core != NULL && (core[BIT_WORD(a)] & BIT_MASK(a)) != 0;
+            set = nextRandom() < (in_core ? core_threshold : noise_threshold);
+        }
+        if (set) {
+            row[BIT_WORD(a)] |= BIT_MASK(a);
+        }
+        previous = set;
+    }
+}
+
+// next value of the splitmix64 generator, the same on every platform
+uint64_t nextRandom(void) {
+    uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+// random values below the threshold occur with the given probability
+uint64_t threshold(double probability) {
+    if (probability >= 1) {
+        return UINT64_MAX;
+    }
+    return (uint64_t) (probability * 18446744073709551616.0);
+}
+
+// write Burmeister header, object and attribute names are their indices as in dataset/
+void writeCxtHeader(FILE *file) {
+    long i;
+    fprintf(file, "B\n\n%ld\n%d\n\n", object_count, attribute_count);
+    for (i = 0; i < object_count; i++) {
+        fprintf(file, "%ld\n", i);
+    }
+    for (i = 0; i < attribute_count; i++) {
+        fprintf(file, "%ld\n", i);
+    }
+}
+
+// write row as 'X' / '.' line
+void writeCxtRow(FILE *file, uint64_t *row, char *line) {
+    int a;
+    for (a = 0; a < attribute_count; a++) {
+        line[a] = (row[BIT_WORD(a)] & BIT_MASK(a)) != 0 ? 'X' : '.';
+    }
+    line[attribute_count] = '\n';
+    fwrite(line, 1, attribute_count + 1, file);
+}
+
+// write binary context header, rows follow as packed attribute words
+void writeBinaryHeader(FILE *file) {
+    binary_context_header_t header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, BINARY_CONTEXT_MAGIC, sizeof(header.magic));
+    header.version = BINARY_CONTEXT_VERSION;
+    header.objects = (uint32_t) object_count;
+    header.attributes = (uint32_t) attribute_count;
+    fwrite(&header, sizeof(header), 1, file);
+}
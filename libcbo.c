@@ -0,0 +1,611 @@
+// -----------------------------------------
+//
+// Close-by-One library
+//
+// Implementation of libcbo.h. The enumeration is the bits engine of cbo_v2: explicit stack of frames, extents by
+// word-wise AND with an attribute column, intent fused with the canonicity test. All state lives in the context
+// handle, read only after loading, and in the iterator of each enumeration, which returns from the search loop at
+// every concept and continues from its stack on the next call. cboEnumerate pulls from an iterator of its own.
+//
+// loadText, loadBinary, closeAndTest and isExtentInColumn are copies of loadData, loadBinaryContext,
+// closeAndTestBits and isExtentInColumnBits of cbo_v2.c, which keeps its state in globals and does not link this
+// file. A change to either side is made to both: the same rows are accepted or refused, and the same concepts are
+// enumerated.
+//
+// -----------------------------------------
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+#include "libcbo.h"
+
+#define WORD_BITS 64 // bits held by one packed bitset word
+#define WORDS_FOR(n) (((n) + WORD_BITS - 1) / WORD_BITS) // words needed to hold n bits
+#define BIT_WORD(i) ((i) / WORD_BITS) // word holding bit i
+#define BIT_MASK(i) (1ULL << ((i) % WORD_BITS)) // mask of bit i inside its word
+
+#define BINARY_CONTEXT_MAGIC "CBOC" // leading bytes of a binary context
+#define BINARY_CONTEXT_VERSION 1 // binary context layout version
+#define BUDGET_TICKS 256 // candidates tried between clock readings of an iterator with a time budget
+
+// define binary_context_header_t for hold binary context header, followed by object rows of packed attribute words
+typedef struct {
+    char magic[4];
+    uint32_t version;
+    uint32_t objects;
+    uint32_t attributes;
+} binary_context_header_t;
+
+// define cbo_context for hold one loaded context
+struct cbo_context {
+    int objects;
+    int attributes;
+    int object_words; // words of an extent
+    int attribute_words; // words of an intent
+    uint64_t *rows; // attribute_words words per object
+    uint64_t *columns; // object_words words per attribute
+};
+
+// define frame_t for hold one level of the explicit Close-by-One stack
+typedef struct {
+    uint64_t *extent;
+    uint64_t *intent;
+    int attr_index; // next attribute to extend with
+} frame_t;
+
+// define cbo_iterator for hold the explicit stack of one enumeration and its budget
+struct cbo_iterator {
+    const cbo_context_t *context;
+    frame_t *frames; // attributes + 1 frames, each level adds at least one attribute
+    int allocated; // depths with buffers allocated
+    int depth; // concept on top of the stack, -1 before the top concept
+    cbo_status_t status;
+    long returned; // concepts returned
+    long limit; // returned count ending the concept budget, 0 for none
+    bool timed; // time budget set
+    struct timespec deadline; // end of the time budget
+    int ticks; // candidates tried since the clock was last read
+    int *objects; // extent indices of the returned concept
+    int *attributes; // intent indices of the returned concept
+};
+
+// local functions
+static cbo_context_t *loadText(const char *data, size_t size, char *error, size_t error_size);
+
+static cbo_context_t *loadBinary(const char *data, size_t size, char *error, size_t error_size);
+
+static cbo_context_t *newContext(int objects, int attributes);
+
+static bool packColumns(cbo_context_t *context);
+
+static bool nextLine(const char **cursor, const char *end, const char **line, size_t *len);
+
+static void setError(char *error, size_t error_size, const char *message);
+
+static bool nextConcept(cbo_iterator_t *iterator, cbo_concept_t *concept);
+
+static bool budgetSpent(cbo_iterator_t *iterator);
+
+static frame_t *frameAt(cbo_iterator_t *iterator, int depth);
+
+static bool closeAndTest(const cbo_context_t *context, uint64_t *intent, uint64_t *extent, uint64_t *attr,
+                         int attr_index);
+
+static bool isExtentInColumn(const cbo_context_t *context, uint64_t *extent, int attr_index);
+
+static void listConcept(cbo_iterator_t *iterator, frame_t *frame, cbo_concept_t *concept);
+
+static int listBits(int *indices, uint64_t *set, int words);
+
+static long findPaddingRow(uint64_t *rows, int objects, int attributes);
+
+// load context from memory, by the leading magic
+cbo_context_t *cboLoadContext(const char *data, size_t size, char *error, size_t error_size) {
+    if (data == NULL || size == 0) {
+        setError(error, error_size, "empty context");
+        return NULL;
+    }
+    if (size >= sizeof(BINARY_CONTEXT_MAGIC) - 1
+        && memcmp(data, BINARY_CONTEXT_MAGIC, sizeof(BINARY_CONTEXT_MAGIC) - 1) == 0) {
+        return loadBinary(data, size, error, error_size);
+    }
+    return loadText(data, size, error, error_size);
+}
+
+// release context handle
+void cboFreeContext(cbo_context_t *context) {
+    if (context == NULL) {
+        return;
+    }
+    free(context->rows);
+    free(context->columns);
+    free(context);
+}
+
+// objects of context
+int cboObjects(const cbo_context_t *context) {
+    return context->objects;
+}
+
+// attributes of context
+int cboAttributes(const cbo_context_t *context) {
+    return context->attributes;
+}
+
+// enumerate every concept into the callback, pulled from an iterator
+long cboEnumerate(const cbo_context_t *context, cbo_concept_fn callback, void *user_data) {
+    cbo_concept_t concept;
+    cbo_iterator_t *iterator = cboOpenIterator(context);
+    if (iterator == NULL) {
+        return -1;
+    }
+    // concepts are only listed as indices for a callback
+    while (nextConcept(iterator, (callback != NULL) ? &concept : NULL)) {
+        if (callback != NULL && !callback(&concept, user_data)) {
+            break; // stopped by the callback
+        }
+    }
+    long concepts = (iterator->status == CBO_NO_MEMORY) ? -1 : iterator->returned;
+    cboCloseIterator(iterator);
+    return concepts;
+}
+
+// start pulled enumeration with an empty stack, the top concept is made by the first cboNext
+cbo_iterator_t *cboOpenIterator(const cbo_context_t *context) {
+    cbo_iterator_t *iterator = (cbo_iterator_t *) calloc(1, sizeof(cbo_iterator_t));
+    if (iterator == NULL) {
+        return NULL;
+    }
+    iterator->context = context;
+    iterator->depth = -1;
+    iterator->status = CBO_MORE;
+    iterator->frames = (frame_t *) calloc(context->attributes + 1, sizeof(frame_t));
+    iterator->objects = (int *) malloc((context->objects + 1) * sizeof(int));
+    iterator->attributes = (int *) malloc((context->attributes + 1) * sizeof(int));
+    if (iterator->frames == NULL || iterator->objects == NULL || iterator->attributes == NULL) {
+        cboCloseIterator(iterator);
+        return NULL;
+    }
+    return iterator;
+}
+
+// next concept as index lists
+bool cboNext(cbo_iterator_t *iterator, cbo_concept_t *concept) {
+    return nextConcept(iterator, concept);
+}
+
+// set concept and time budget counted from now
+void cboSetBudget(cbo_iterator_t *iterator, long concepts, double seconds) {
+    iterator->limit = (concepts > 0) ? iterator->returned + concepts : 0;
+    iterator->timed = seconds > 0;
+    if (iterator->timed) {
+        clock_gettime(CLOCK_MONOTONIC, &iterator->deadline);
+        long nanoseconds = iterator->deadline.tv_nsec + (long) ((seconds - (long) seconds) * 1e9);
+        iterator->deadline.tv_sec += (time_t) seconds + nanoseconds / 1000000000L;
+        iterator->deadline.tv_nsec = nanoseconds % 1000000000L;
+    }
+    iterator->ticks = 0;
+    if (iterator->status == CBO_BUDGET) {
+        iterator->status = CBO_MORE; // resume where the last budget stopped
+    }
+}
+
+// state after the last cboNext
+cbo_status_t cboStatus(const cbo_iterator_t *iterator) {
+    return iterator->status;
+}
+
+// concepts returned so far
+long cboReturned(const cbo_iterator_t *iterator) {
+    return iterator->returned;
+}
+
+// release every frame and output buffer of the iterator
+void cboCloseIterator(cbo_iterator_t *iterator) {
+    int d;
+    if (iterator == NULL) {
+        return;
+    }
+    for (d = 0; d < iterator->allocated; d++) {
+        free(iterator->frames[d].extent);
+        free(iterator->frames[d].intent);
+    }
+    free(iterator->frames);
+    free(iterator->objects);
+    free(iterator->attributes);
+    free(iterator);
+}
+
+/**
+ * Close-by-One Algorithm on bitsets
+ *
+ * The recursion runs on the explicit stack of the iterator, the concept at depth d and the attribute to try next
+ * live in frame d. A canonical child is pushed and returned at once, the next call continues with the attributes
+ * of that child, so the search between two calls is exactly the one of an uninterrupted run. The budget is checked
+ * before each candidate, a frame's next attribute is advanced only once its candidate is tried.
+ *
+ * input :  1. iterator
+ *          2. concept to fill, NULL when the concept is only counted
+ */
+static bool nextConcept(cbo_iterator_t *iterator, cbo_concept_t *concept) {
+    int i, w;
+    const cbo_context_t *context = iterator->context;
+    int object_words = context->object_words;
+    frame_t *frame;
+    if (iterator->status != CBO_MORE) {
+        return false;
+    }
+    if (budgetSpent(iterator)) {
+        iterator->status = CBO_BUDGET;
+        return false;
+    }
+    if (iterator->depth < 0) {
+        if (iterator->returned > 0 || (frame = frameAt(iterator, 0)) == NULL) {
+            iterator->status = (iterator->returned > 0) ? CBO_DONE : CBO_NO_MEMORY;
+            return false;
+        }
+        // 1. top concept, all objects and the attributes common to all of them
+        memset(frame->extent, 0, object_words * sizeof(uint64_t));
+        for (i = 0; i < context->objects; i++) {
+            frame->extent[BIT_WORD(i)] |= BIT_MASK(i);
+        }
+        memset(frame->intent, 0, context->attribute_words * sizeof(uint64_t));
+        for (i = 0; i < context->attributes; i++) {
+            if (isExtentInColumn(context, frame->extent, i)) {
+                frame->intent[BIT_WORD(i)] |= BIT_MASK(i);
+            }
+        }
+        frame->attr_index = 0;
+        iterator->depth = 0;
+        listConcept(iterator, frame, concept);
+        return true;
+    }
+    while (iterator->depth >= 0) {
+        frame = &iterator->frames[iterator->depth];
+        // 2. go through remaining attributes of the concept on top of the stack
+        while (frame->attr_index < context->attributes) {
+            int j = frame->attr_index;
+            // 3. check current attribute exist or not
+            if ((frame->intent[BIT_WORD(j)] & BIT_MASK(j)) != 0) {
+                frame->attr_index++;
+                continue;
+            }
+            if (iterator->timed && ++iterator->ticks >= BUDGET_TICKS && budgetSpent(iterator)) {
+                iterator->status = CBO_BUDGET; // j is tried first when resumed
+                return false;
+            }
+            // 4. make extent in the next frame
+            frame_t *child = frameAt(iterator, iterator->depth + 1);
+            if (child == NULL) {
+                iterator->status = CBO_NO_MEMORY;
+                return false;
+            }
+            uint64_t *column = &context->columns[(size_t) j * object_words];
+            for (w = 0; w < object_words; w++) {
+                child->extent[w] = frame->extent[w] & column[w];
+            }
+            frame->attr_index++;
+            // 5. make intent fused with canonicity test
+            if (closeAndTest(context, child->intent, child->extent, frame->intent, j)) {
+                // 6. push child and return it, the next call continues from its first attribute
+                child->attr_index = j + 1;
+                iterator->depth++;
+                listConcept(iterator, child, concept);
+                return true;
+            }
+        }
+        iterator->depth--; // attributes exhausted, pop
+    }
+    iterator->status = CBO_DONE;
+    return false;
+}
+
+// check concept or time budget of iterator is spent, the clock is read only when asked by the caller
+static bool budgetSpent(cbo_iterator_t *iterator) {
+    struct timespec now;
+    if (iterator->limit > 0 && iterator->returned >= iterator->limit) {
+        return true;
+    }
+    if (!iterator->timed) {
+        return false;
+    }
+    iterator->ticks = 0;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec > iterator->deadline.tv_sec
+           || (now.tv_sec == iterator->deadline.tv_sec && now.tv_nsec >= iterator->deadline.tv_nsec);
+}
+
+/**
+ * load Burmeister .cxt text, blank lines are skipped
+ * B, object count, attribute count, object names, attribute names, one row of 'X' / '.' per object
+ */
+static cbo_context_t *loadText(const char *data, size_t size, char *error, size_t error_size) {
+    const char *cursor = data;
+    const char *end = data + size;
+    const char *line;
+    size_t len;
+    int i, x;
+    int objects, attributes;
+    if (!nextLine(&cursor, end, &line, &len) || line[0] != 'B') {
+        setError(error, error_size, "missing Burmeister header");
+        return NULL;
+    }
+    // counts are parsed from the line only, it is not terminated
+    char number[16];
+    if (!nextLine(&cursor, end, &line, &len) || len >= sizeof(number)
+        || (memcpy(number, line, len), number[len] = '\0', objects = atoi(number)) <= 0
+        || !nextLine(&cursor, end, &line, &len) || len >= sizeof(number)
+        || (memcpy(number, line, len), number[len] = '\0', attributes = atoi(number)) <= 0) {
+        setError(error, error_size, "invalid context size");
+        return NULL;
+    }
+    // object and attribute names are not used
+    for (i = 0; i < objects + attributes; i++) {
+        if (!nextLine(&cursor, end, &line, &len)) {
+            setError(error, error_size, "missing names");
+            return NULL;
+        }
+    }
+    cbo_context_t *context = newContext(objects, attributes);
+    if (context == NULL) {
+        setError(error, error_size, "out of memory");
+        return NULL;
+    }
+    // read cross table into object rows
+    for (i = 0; i < objects; i++) {
+        if (!nextLine(&cursor, end, &line, &len)) {
+            snprintf(error, error != NULL ? error_size : 0, "found %d of %d rows", i, objects);
+            cboFreeContext(context);
+            return NULL;
+        }
+        uint64_t *row = &context->rows[(size_t) i * context->attribute_words];
+        for (x = 0; x < attributes && x < (int) len; x++) {
+            // set when 'X', clear when '.' or row ends early
+            if (line[x] == 'X' || line[x] == 'x') {
+                row[BIT_WORD(x)] |= BIT_MASK(x);
+            }
+        }
+    }
+    if (!packColumns(context)) {
+        setError(error, error_size, "out of memory");
+        cboFreeContext(context);
+        return NULL;
+    }
+    return context;
+}
+
+// load binary context, header followed by packed object rows
+static cbo_context_t *loadBinary(const char *data, size_t size, char *error, size_t error_size) {
+    binary_context_header_t header;
+    if (size < sizeof(header)) {
+        setError(error, error_size, "invalid binary context header");
+        return NULL;
+    }
+    memcpy(&header, data, sizeof(header));
+    if (memcmp(header.magic, BINARY_CONTEXT_MAGIC, sizeof(header.magic)) != 0) {
+        setError(error, error_size, "not a binary context");
+        return NULL;
+    }
+    if (header.version != BINARY_CONTEXT_VERSION || header.objects == 0 || header.attributes == 0
+        || header.objects > INT32_MAX || header.attributes > INT32_MAX) {
+        setError(error, error_size, "invalid binary context header");
+        return NULL;
+    }
+    size_t rows_size = (size_t) header.objects * WORDS_FOR((size_t) header.attributes) * sizeof(uint64_t);
+    if (size != sizeof(header) + rows_size) {
+        setError(error, error_size, "size does not match header");
+        return NULL;
+    }
+    cbo_context_t *context = newContext((int) header.objects, (int) header.attributes);
+    if (context == NULL) {
+        setError(error, error_size, "out of memory");
+        return NULL;
+    }
+    memcpy(context->rows, data + sizeof(header), rows_size);
+    // bits past the last attribute would be transposed into columns that do not exist
+    long row = findPaddingRow(context->rows, context->objects, context->attributes);
+    if (row >= 0) {
+        snprintf(error, error != NULL ? error_size : 0, "row %ld has bits past attribute %d", row,
+                 context->attributes - 1);
+        cboFreeContext(context);
+        return NULL;
+    }
+    if (!packColumns(context)) {
+        setError(error, error_size, "out of memory");
+        cboFreeContext(context);
+        return NULL;
+    }
+    return context;
+}
+
+// allocate context with cleared object rows, NULL when memory runs out
+static cbo_context_t *newContext(int objects, int attributes) {
+    cbo_context_t *context = (cbo_context_t *) calloc(1, sizeof(cbo_context_t));
+    if (context == NULL) {
+        return NULL;
+    }
+    context->objects = objects;
+    context->attributes = attributes;
+    context->object_words = WORDS_FOR(objects);
+    context->attribute_words = WORDS_FOR(attributes);
+    context->rows = (uint64_t *) calloc((size_t) objects * context->attribute_words, sizeof(uint64_t));
+    if (context->rows == NULL) {
+        free(context);
+        return NULL;
+    }
+    return context;
+}
+
+// transpose object rows into attribute columns
+static bool packColumns(cbo_context_t *context) {
+    int i, w;
+    context->columns = (uint64_t *) calloc((size_t) context->attributes * context->object_words, sizeof(uint64_t));
+    if (context->columns == NULL) {
+        return false;
+    }
+    for (i = 0; i < context->objects; i++) {
+        uint64_t *row = &context->rows[(size_t) i * context->attribute_words];
+        for (w = 0; w < context->attribute_words; w++) {
+            uint64_t bits = row[w];
+            while (bits != 0) {
+                int a = w * WORD_BITS + __builtin_ctzll(bits);
+                context->columns[(size_t) a * context->object_words + BIT_WORD(i)] |= BIT_MASK(i);
+                bits &= bits - 1;
+            }
+        }
+    }
+    return true;
+}
+
+// first packed row with a bit set at or above attributes in its last word, -1 when every row is clean
+static long findPaddingRow(uint64_t *rows, int objects, int attributes) {
+    int words = WORDS_FOR(attributes);
+    long i;
+    if (attributes % WORD_BITS == 0) {
+        return -1; // last word holds attributes only
+    }
+    uint64_t padding = ~(BIT_MASK(attributes) - 1); // bits of the last word past the last attribute
+    for (i = 0; i < objects; i++) {
+        if ((rows[i * words + words - 1] & padding) != 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// move cursor to the next non blank line, line excludes the line break
+static bool nextLine(const char **cursor, const char *end, const char **line, size_t *len) {
+    while (*cursor < end) {
+        const char *start = *cursor;
+        const char *stop = memchr(start, '\n', end - start);
+        if (stop == NULL) {
+            stop = end;
+        }
+        *cursor = (stop < end) ? stop + 1 : end;
+        size_t length = stop - start;
+        if (length > 0 && start[length - 1] == '\r') {
+            length--;
+        }
+        if (length > 0) {
+            *line = start;
+            *len = length;
+            return true;
+        }
+    }
+    return false;
+}
+
+// copy failure reason into the caller's buffer, when given
+static void setError(char *error, size_t error_size, const char *message) {
+    if (error != NULL && error_size > 0) {
+        snprintf(error, error_size, "%s", message);
+    }
+}
+
+// frame of given depth, allocating its buffers the first time the depth is reached, NULL when memory runs out
+static frame_t *frameAt(cbo_iterator_t *iterator, int depth) {
+    frame_t *frame = &iterator->frames[depth];
+    if (depth < iterator->allocated) {
+        return frame;
+    }
+    // depths are reached one at a time
+    frame->extent = (uint64_t *) malloc(iterator->context->object_words * sizeof(uint64_t));
+    frame->intent = (uint64_t *) malloc(iterator->context->attribute_words * sizeof(uint64_t));
+    iterator->allocated = depth + 1; // freed with the others even when incomplete
+    return (frame->extent != NULL && frame->intent != NULL) ? frame : NULL;
+}
+
+/**
+ * make intent fused with canonicity test
+ *
+ * Attributes of attr are in the closure of any extent taken from attr's objects, so only the others are tested.
+ * Those below attr_index are tested first and the first one found rejects the candidate, the intent is finished
+ * from attr_index on only when none is found.
+ *
+ * input :  1. context handle
+ *          2. intent to fill, complete only when true is returned
+ *          3. extent of the candidate
+ *          4. attribute set of the parent concept
+ *          5. current attribute index
+ */
+static bool closeAndTest(const cbo_context_t *context, uint64_t *intent, uint64_t *extent, uint64_t *attr,
+                         int attr_index) {
+    int w;
+    int attribute_words = context->attribute_words;
+    int split_word = BIT_WORD(attr_index);
+    uint64_t below = BIT_MASK(attr_index) - 1; // bits below attr_index in the split word
+    uint64_t last = (context->attributes % WORD_BITS != 0) ? BIT_MASK(context->attributes) - 1 : ~0ULL;
+    // 1. attributes below attr_index, rejected on the first new one
+    for (w = 0; w <= split_word && w < attribute_words; w++) {
+        uint64_t candidates = ~attr[w];
+        if (w == split_word) {
+            candidates &= below;
+        }
+        while (candidates != 0) {
+            if (isExtentInColumn(context, extent, w * WORD_BITS + __builtin_ctzll(candidates))) {
+                return false;
+            }
+            candidates &= candidates - 1;
+        }
+    }
+    // 2. canonical, finish attributes from attr_index on
+    memcpy(intent, attr, attribute_words * sizeof(uint64_t));
+    for (w = split_word; w < attribute_words; w++) {
+        uint64_t candidates = ~attr[w];
+        if (w == split_word) {
+            candidates &= ~below;
+        }
+        if (w == attribute_words - 1) {
+            candidates &= last;
+        }
+        while (candidates != 0) {
+            int a = w * WORD_BITS + __builtin_ctzll(candidates);
+            if (isExtentInColumn(context, extent, a)) {
+                intent[w] |= BIT_MASK(a);
+            }
+            candidates &= candidates - 1;
+        }
+    }
+    return true;
+}
+
+// check every object of extent has attribute attr_index
+static bool isExtentInColumn(const cbo_context_t *context, uint64_t *extent, int attr_index) {
+    int w;
+    uint64_t *column = &context->columns[(size_t) attr_index * context->object_words];
+    for (w = 0; w < context->object_words; w++) {
+        if ((extent[w] & ~column[w]) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// count concept as returned and list its extent and intent as indices, when asked
+static void listConcept(cbo_iterator_t *iterator, frame_t *frame, cbo_concept_t *concept) {
+    iterator->returned++;
+    if (concept == NULL) {
+        return;
+    }
+    concept->objects = iterator->objects;
+    concept->object_count = listBits(iterator->objects, frame->extent, iterator->context->object_words);
+    concept->attributes = iterator->attributes;
+    concept->attribute_count = listBits(iterator->attributes, frame->intent, iterator->context->attribute_words);
+}
+
+// write indices of the bits set, returns their count
+static int listBits(int *indices, uint64_t *set, int words) {
+    int w;
+    int count = 0;
+    for (w = 0; w < words; w++) {
+        uint64_t bits = set[w];
+        while (bits != 0) {
+            indices[count++] = w * WORD_BITS + __builtin_ctzll(bits);
+            bits &= bits - 1;
+        }
+    }
+    return count;
+}
@@ -0,0 +1,118 @@
+// -----------------------------------------
+//
+// Close-by-One library
+//
+// Reentrant Close-by-One on packed 64-bit bitsets. A context is loaded from memory into a handle, and concepts are
+// enumerated into a callback with user data, or pulled one at a time from an iterator that can be stopped and given
+// concept and time budgets. Nothing is kept in globals: a loaded context is read only, every enumeration keeps its
+// own stack, so independent contexts (or one context) can be enumerated from many threads at once. Errors are
+// returned, the library never prints or exits.
+//
+// -----------------------------------------
+
+#ifndef LIBCBO_H
+#define LIBCBO_H
+
+#include <stddef.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CBO_ERROR_SIZE 128 // bytes of an error message buffer
+
+// define cbo_context_t for hold one loaded context, packed object rows and attribute columns
+typedef struct cbo_context cbo_context_t;
+
+// define cbo_iterator_t for hold the Close-by-One stack of one pulled enumeration
+typedef struct cbo_iterator cbo_iterator_t;
+
+// state of an iterator after its last cboNext
+typedef enum {
+    CBO_MORE, // a concept was returned, the enumeration goes on
+    CBO_DONE, // every concept was returned
+    CBO_BUDGET, // concept or time budget spent, a new budget resumes the enumeration
+    CBO_NO_MEMORY // stack frame could not be allocated, the iterator can only be closed
+} cbo_status_t;
+
+// define cbo_concept_t for hold one concept, valid during the callback or until the next cboNext
+typedef struct {
+    const int *objects; // extent as ascending object indices
+    int object_count;
+    const int *attributes; // intent as ascending attribute indices
+    int attribute_count;
+} cbo_concept_t;
+
+// concept callback, returning false stops the enumeration
+typedef bool (*cbo_concept_fn)(const cbo_concept_t *concept, void *user_data);
+
+/**
+ * load context from memory, a Burmeister .cxt text or a binary context (CBOC magic), data is not kept
+ *
+ * input :  1. context bytes
+ *          2. byte count
+ *          3. buffer for the reason of a failure, may be NULL
+ *          4. buffer size
+ *
+ * returns the context handle, NULL on failure
+ */
+cbo_context_t *cboLoadContext(const char *data, size_t size, char *error, size_t error_size);
+
+// release context handle
+void cboFreeContext(cbo_context_t *context);
+
+// objects of context
+int cboObjects(const cbo_context_t *context);
+
+// attributes of context
+int cboAttributes(const cbo_context_t *context);
+
+/**
+ * enumerate every concept of context in Close-by-One order
+ *
+ * input :  1. context handle
+ *          2. callback receiving each concept, NULL only counts
+ *          3. user data handed to the callback
+ *
+ * returns the concepts handed out, -1 when memory runs out
+ */
+long cboEnumerate(const cbo_context_t *context, cbo_concept_fn callback, void *user_data);
+
+// start pulled enumeration of context, which must outlive the iterator, NULL when memory runs out
+cbo_iterator_t *cboOpenIterator(const cbo_context_t *context);
+
+/**
+ * next concept in Close-by-One order
+ *
+ * input :  1. iterator
+ *          2. concept, filled when true is returned and valid until the next call
+ *
+ * returns false when the enumeration is done, the budget is spent or memory ran out, told apart by cboStatus
+ */
+bool cboNext(cbo_iterator_t *iterator, cbo_concept_t *concept);
+
+/**
+ * limit the concepts returned and time spent from now on, the search stops between two candidates once either is
+ * reached, cboNext then returns false until another budget is set and the search resumes where it stopped
+ *
+ * input :  1. iterator
+ *          2. concepts to return, 0 for no limit
+ *          3. seconds of wall time, 0 for no limit
+ */
+void cboSetBudget(cbo_iterator_t *iterator, long concepts, double seconds);
+
+// state of iterator after its last cboNext
+cbo_status_t cboStatus(const cbo_iterator_t *iterator);
+
+// concepts returned by iterator so far
+long cboReturned(const cbo_iterator_t *iterator);
+
+// release iterator, the enumeration may be unfinished
+void cboCloseIterator(cbo_iterator_t *iterator);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // LIBCBO_H